@@ -0,0 +1,746 @@
+#include "ComputeBatch.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <algorithm>
+
+const int HISTOGRAM_BINS = 256;
+const uint32_t COMPUTE_GROUP_SIZE = 16;					// Matches local_size_x/y in the job shaders
+
+// Push constants shared by every job shader
+struct ComputePushConstants {
+	uint32_t width;
+	uint32_t height;
+};
+
+const char* computeJobName(ComputeJobType job)
+{
+	switch (job) {
+	case ComputeJobType::ColourConvert:	return "colour convert";
+	case ComputeJobType::Resize:		return "resize";
+	case ComputeJobType::Histogram:		return "histogram";
+	default:							return "unknown";
+	}
+}
+
+static const char* computeJobShader(ComputeJobType job)
+{
+	switch (job) {
+	case ComputeJobType::ColourConvert:	return "Shaders/colour_convert.spv";
+	case ComputeJobType::Resize:		return "Shaders/resize.spv";
+	case ComputeJobType::Histogram:		return "Shaders/histogram.spv";
+	default:							return nullptr;
+	}
+}
+
+// -- CPU REFERENCE --
+// Same integer maths as the shaders, so results must match exactly
+
+static uint32_t referenceLuma(uint32_t pixel)
+{
+	uint32_t r = pixel & 0xFF;
+	uint32_t g = (pixel >> 8) & 0xFF;
+	uint32_t b = (pixel >> 16) & 0xFF;
+	return (77 * r + 150 * g + 29 * b + 128) >> 8;
+}
+
+static void referenceColourConvert(const uint32_t* source, uint32_t width, uint32_t height, uint32_t* destination)
+{
+	for (uint32_t i = 0; i < width * height; i++) {
+		uint32_t y = referenceLuma(source[i]);
+		destination[i] = y | (y << 8) | (y << 16) | (source[i] & 0xFF000000u);
+	}
+}
+
+static void referenceResize(const uint32_t* source, uint32_t width, uint32_t height, uint32_t* destination)
+{
+	uint32_t dstWidth = width / 2;
+	uint32_t dstHeight = height / 2;
+
+	for (uint32_t y = 0; y < dstHeight; y++) {
+		for (uint32_t x = 0; x < dstWidth; x++) {
+			const uint32_t* p = source + (y * 2) * width + x * 2;
+			uint32_t result = 0;
+			for (uint32_t shift = 0; shift < 32; shift += 8) {
+				uint32_t sum = ((p[0] >> shift) & 0xFF) + ((p[1] >> shift) & 0xFF) + ((p[width] >> shift) & 0xFF) + ((p[width + 1] >> shift) & 0xFF);
+				result |= ((sum + 2) / 4) << shift;
+			}
+			destination[y * dstWidth + x] = result;
+		}
+	}
+}
+
+static void referenceHistogram(const uint32_t* source, uint32_t width, uint32_t height, uint32_t* bins)
+{
+	memset(bins, 0, HISTOGRAM_BINS * sizeof(uint32_t));
+	for (uint32_t i = 0; i < width * height; i++) {
+		bins[referenceLuma(source[i])]++;
+	}
+}
+
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+ComputeBatchProcessor::ComputeBatchProcessor()
+{
+}
+
+ComputeBatchProcessor::~ComputeBatchProcessor()
+{
+}
+
+void ComputeBatchProcessor::init(VulkanContext* newContext, const ComputeBatchSettings& newSettings)
+{
+	context = newContext;
+	settings = newSettings;
+
+	if (settings.imageWidth < 2 || settings.imageHeight < 2 || settings.imagesPerBatch == 0 || settings.jobs.empty()) {
+		throw std::runtime_error("Invalid compute batch settings!");
+	}
+
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(context->getPhysicalDevice(), &deviceProperties);
+
+	// Every image in a batch is one z slice of the dispatch
+	if (settings.imagesPerBatch > deviceProperties.limits.maxComputeWorkGroupCount[2]) {
+		throw std::runtime_error("Too many images per batch for maxComputeWorkGroupCount!");
+	}
+
+	// Each job writes its own region of the output buffer, aligned so it can be bound as a storage buffer
+	VkDeviceSize pixelsPerImage = static_cast<VkDeviceSize>(settings.imageWidth) * settings.imageHeight;
+	inputSize = pixelsPerImage * sizeof(uint32_t) * settings.imagesPerBatch;
+
+	outputSize = 0;
+	for (ComputeJobType job : settings.jobs) {
+		JobOutput jobOutput = {};
+		jobOutput.type = job;
+
+		switch (job) {
+		case ComputeJobType::ColourConvert:
+			jobOutput.bytesPerImage = pixelsPerImage * sizeof(uint32_t);
+			break;
+		case ComputeJobType::Resize:
+			jobOutput.bytesPerImage = static_cast<VkDeviceSize>(settings.imageWidth / 2) * (settings.imageHeight / 2) * sizeof(uint32_t);
+			break;
+		case ComputeJobType::Histogram:
+			jobOutput.bytesPerImage = HISTOGRAM_BINS * sizeof(uint32_t);
+			break;
+		default:
+			throw std::runtime_error("Unknown compute job!");
+		}
+
+		jobOutput.offset = alignUp(outputSize, deviceProperties.limits.minStorageBufferOffsetAlignment);
+		jobOutput.size = jobOutput.bytesPerImage * settings.imagesPerBatch;
+		outputSize = jobOutput.offset + jobOutput.size;
+
+		if (jobOutput.size > deviceProperties.limits.maxStorageBufferRange) {
+			throw std::runtime_error("Compute job output exceeds maxStorageBufferRange!");
+		}
+
+		jobOutputs.push_back(jobOutput);
+	}
+
+	if (inputSize > deviceProperties.limits.maxStorageBufferRange) {
+		throw std::runtime_error("Compute batch input exceeds maxStorageBufferRange!");
+	}
+
+	CreateDescriptorSetLayout();
+	CreatePipelineLayout();
+	CreateJobPipelines();
+	CreateBatchSlots();
+	CreateDescriptorPool();
+	CreateDescriptorSets();
+
+	// Buffers never change, so each slot's commands are recorded once and resubmitted for every batch it takes
+	for (auto& slot : batchSlots) {
+		RecordBatch(slot);
+	}
+}
+
+ComputeBatchResults ComputeBatchProcessor::Run()
+{
+	using Clock = std::chrono::steady_clock;
+
+	ComputeBatchResults results;
+	verifyOutputs.clear();
+
+	Clock::time_point start = Clock::now();
+
+	for (uint64_t batch = 0; batch < settings.batchCount; batch++) {
+		BatchSlot& slot = batchSlots[batch % batchSlots.size()];
+
+		// -- READ BACK --
+		// Slot still holds the batch from COMPUTE_BATCHES_IN_FLIGHT ago, finish with it first
+		if (slot.batchIndex >= 0) {
+			ReadBackBatch(slot, results);
+		}
+
+		// -- LOAD --
+		// Written straight into the slot's mapped staging buffer while the GPU works on the other slots
+		Clock::time_point loadStart = Clock::now();
+		LoadBatch(batch, slot.stagingData);
+		results.loadSeconds += std::chrono::duration<double>(Clock::now() - loadStart).count();
+
+		// -- UPLOAD, DISPATCH, COPY BACK --
+		slot.batchIndex = static_cast<int64_t>(batch);
+		SubmitBatch(slot);
+	}
+
+	// Drain the slots still in flight, oldest first
+	for (size_t i = 0; i < batchSlots.size(); i++) {
+		BatchSlot& slot = batchSlots[(settings.batchCount + i) % batchSlots.size()];
+		if (slot.batchIndex >= 0) {
+			ReadBackBatch(slot, results);
+		}
+	}
+
+	results.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	results.imagesPerSecond = results.seconds > 0.0 ? results.imagesProcessed / results.seconds : 0.0;
+
+	// -- VERIFY --
+	// Outside the timed loop, so the reference doesn't slow the pipeline it is checking
+	double referenceSeconds = 0.0;
+	for (size_t batch = 0; batch < verifyOutputs.size(); batch++) {
+		results.mismatches += VerifyBatch(batch, verifyOutputs[batch].data(), referenceSeconds);
+		results.imagesVerified += settings.imagesPerBatch;
+	}
+
+	if (referenceSeconds > 0.0) {
+		results.referenceImagesPerSecond = results.imagesVerified / referenceSeconds;
+	}
+
+	return results;
+}
+
+void ComputeBatchProcessor::CreateDescriptorSetLayout()
+{
+	// Every job reads the batch input (binding 0) and writes its own output region (binding 1)
+	VkDescriptorSetLayoutBinding bindings[2] = {};
+	for (uint32_t i = 0; i < 2; i++) {
+		bindings[i].binding = i;													// Binding point in shader
+		bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;				// Type of descriptor
+		bindings[i].descriptorCount = 1;											// Number of descriptors for binding
+		bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;						// Shader stage to bind to
+		bindings[i].pImmutableSamplers = nullptr;
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+	layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutCreateInfo.bindingCount = 2;
+	layoutCreateInfo.pBindings = bindings;
+
+	VkResult result = vkCreateDescriptorSetLayout(context->getLogicalDevice(), &layoutCreateInfo, nullptr, &descriptorSetLayout);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Descriptor Set Layout!");
+	}
+
+	context->getDeletionQueue().push([this]() {
+		vkDestroyDescriptorSetLayout(context->getLogicalDevice(), descriptorSetLayout, nullptr);
+	});
+}
+
+void ComputeBatchProcessor::CreatePipelineLayout()
+{
+	VkPushConstantRange pushConstantRange = {};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(ComputePushConstants);
+
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayout;
+	pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+	pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+
+	VkResult result = vkCreatePipelineLayout(context->getLogicalDevice(), &pipelineLayoutCreateInfo, nullptr, &pipelineLayout);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create Pipeline Layout!");
+	}
+
+	context->getDeletionQueue().push([this]() {
+		vkDestroyPipelineLayout(context->getLogicalDevice(), pipelineLayout, nullptr);
+	});
+}
+
+void ComputeBatchProcessor::CreateJobPipelines()
+{
+	for (ComputeJobType job : settings.jobs) {
+		// A job can appear in the queue more than once, but only needs one pipeline
+		VkPipeline& pipeline = jobPipelines[static_cast<int>(job)];
+		if (pipeline != VK_NULL_HANDLE) {
+			continue;
+		}
+
+		// Read in SPIR-V code of shader (built by Shaders/compile.bat or compile.sh). Look next to the
+		// executable first, so it runs from any directory, then in the working directory (e.g. the IDE's project folder)
+		std::string shaderPath = VulkanContext::getExecutableDirectory() + computeJobShader(job);
+		if (!std::ifstream(shaderPath).good()) {
+			shaderPath = computeJobShader(job);
+		}
+		std::vector<char> shaderCode = readFile(shaderPath);
+		VkShaderModule shaderModule = createShaderModule(shaderCode);
+
+		VkPipelineShaderStageCreateInfo shaderStageCreateInfo = {};
+		shaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		shaderStageCreateInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;					// Shader Stage name
+		shaderStageCreateInfo.module = shaderModule;								// Shader module to be used by stage
+		shaderStageCreateInfo.pName = "main";										// Entry point in to shader
+
+		VkComputePipelineCreateInfo pipelineCreateInfo = {};
+		pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineCreateInfo.stage = shaderStageCreateInfo;
+		pipelineCreateInfo.layout = pipelineLayout;
+
+		VkResult result = vkCreateComputePipelines(context->getLogicalDevice(), context->getPipelineCache(), 1, &pipelineCreateInfo, nullptr, &pipeline);
+
+		// Shader module no longer needed once the pipeline exists
+		vkDestroyShaderModule(context->getLogicalDevice(), shaderModule, nullptr);
+
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create a Compute Pipeline!");
+		}
+
+		context->getDeletionQueue().push([this, pipeline]() {
+			vkDestroyPipeline(context->getLogicalDevice(), pipeline, nullptr);
+		});
+	}
+}
+
+void ComputeBatchProcessor::CreateBatchSlots()
+{
+	VkPhysicalDevice physicalDevice = context->getPhysicalDevice();
+	VkDevice device = context->getLogicalDevice();
+
+	// Only memory types the readback buffers allow can be picked, so create one first to get its requirements.
+	// Buffers with the same size and usage have the same requirements, so it stands in for every slot
+	VkBufferCreateInfo readbackInfo = {};
+	readbackInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	readbackInfo.size = outputSize;
+	readbackInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	readbackInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	VkBuffer readbackProbe;
+	if (vkCreateBuffer(device, &readbackInfo, nullptr, &readbackProbe) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Buffer!");
+	}
+
+	VkMemoryRequirements readbackRequirements;
+	vkGetBufferMemoryRequirements(device, readbackProbe, &readbackRequirements);
+	vkDestroyBuffer(device, readbackProbe, nullptr);
+
+	// Readback is read by the CPU, so cached memory is much faster to read from. Prefer cached and coherent,
+	// then cached (needs an invalidate before reading), then whatever host visible memory there is
+	const VkMemoryPropertyFlags readbackCandidates[] = {
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+	};
+
+	VkMemoryPropertyFlags readbackProperties = readbackCandidates[2];
+	for (VkMemoryPropertyFlags candidate : readbackCandidates) {
+		if (findMemoryTypeIndex(physicalDevice, readbackRequirements.memoryTypeBits, candidate) != UINT32_MAX) {
+			readbackProperties = candidate;
+			break;
+		}
+	}
+	readbackCoherent = (readbackProperties & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+	batchSlots.resize(COMPUTE_BATCHES_IN_FLIGHT);
+
+	// One command buffer per slot, recorded once in init
+	std::vector<VkCommandBuffer> commandBuffers(batchSlots.size());
+
+	VkCommandBufferAllocateInfo cbAllocInfo = {};
+	cbAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	cbAllocInfo.commandPool = context->getComputeCommandPool();
+	cbAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	cbAllocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+
+	VkResult result = vkAllocateCommandBuffers(device, &cbAllocInfo, commandBuffers.data());
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to allocate Command Buffers!");
+	}
+
+	// Start signalled, so a slot that has never been used doesn't need special casing
+	VkFenceCreateInfo fenceCreateInfo = {};
+	fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+	for (size_t i = 0; i < batchSlots.size(); i++) {
+		BatchSlot& slot = batchSlots[i];
+		slot.commandBuffer = commandBuffers[i];
+
+		createBuffer(physicalDevice, device, inputSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &slot.stagingBuffer, &slot.stagingMemory);
+		createBuffer(physicalDevice, device, inputSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &slot.inputBuffer, &slot.inputMemory);
+		createBuffer(physicalDevice, device, outputSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &slot.outputBuffer, &slot.outputMemory);
+		createBuffer(physicalDevice, device, outputSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			readbackProperties, &slot.readbackBuffer, &slot.readbackMemory);
+
+		// Staging and readback stay mapped for the whole run
+		if (vkMapMemory(device, slot.stagingMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&slot.stagingData)) != VK_SUCCESS ||
+			vkMapMemory(device, slot.readbackMemory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&slot.readbackData)) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to map compute batch memory!");
+		}
+
+		result = vkCreateFence(device, &fenceCreateInfo, nullptr, &slot.fence);
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create a Fence!");
+		}
+	}
+
+	context->getDeletionQueue().push([this]() {
+		VkDevice device = context->getLogicalDevice();
+		for (auto& slot : batchSlots) {
+			vkDestroyFence(device, slot.fence, nullptr);
+			vkDestroyBuffer(device, slot.readbackBuffer, nullptr);
+			vkFreeMemory(device, slot.readbackMemory, nullptr);			// Freeing also unmaps
+			vkDestroyBuffer(device, slot.outputBuffer, nullptr);
+			vkFreeMemory(device, slot.outputMemory, nullptr);
+			vkDestroyBuffer(device, slot.inputBuffer, nullptr);
+			vkFreeMemory(device, slot.inputMemory, nullptr);
+			vkDestroyBuffer(device, slot.stagingBuffer, nullptr);
+			vkFreeMemory(device, slot.stagingMemory, nullptr);
+		}
+	});
+}
+
+void ComputeBatchProcessor::CreateDescriptorPool()
+{
+	uint32_t setCount = static_cast<uint32_t>(batchSlots.size() * jobOutputs.size());
+
+	// Two storage buffers (input and output) per set
+	VkDescriptorPoolSize poolSize = {};
+	poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSize.descriptorCount = setCount * 2;
+
+	VkDescriptorPoolCreateInfo poolCreateInfo = {};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.maxSets = setCount;											// Maximum number of Descriptor Sets that can be created from pool
+	poolCreateInfo.poolSizeCount = 1;											// Amount of Pool Sizes being passed
+	poolCreateInfo.pPoolSizes = &poolSize;										// Pool Sizes to create pool with
+
+	VkResult result = vkCreateDescriptorPool(context->getLogicalDevice(), &poolCreateInfo, nullptr, &descriptorPool);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Descriptor Pool!");
+	}
+
+	context->getDeletionQueue().push([this]() {
+		vkDestroyDescriptorPool(context->getLogicalDevice(), descriptorPool, nullptr);
+	});
+}
+
+void ComputeBatchProcessor::CreateDescriptorSets()
+{
+	for (auto& slot : batchSlots) {
+		slot.jobDescriptorSets.resize(jobOutputs.size());
+
+		std::vector<VkDescriptorSetLayout> setLayouts(jobOutputs.size(), descriptorSetLayout);
+
+		VkDescriptorSetAllocateInfo setAllocInfo = {};
+		setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		setAllocInfo.descriptorPool = descriptorPool;												// Pool to allocate Descriptor Set from
+		setAllocInfo.descriptorSetCount = static_cast<uint32_t>(setLayouts.size());				// Number of sets to allocate
+		setAllocInfo.pSetLayouts = setLayouts.data();												// Layouts to use to allocate sets
+
+		VkResult result = vkAllocateDescriptorSets(context->getLogicalDevice(), &setAllocInfo, slot.jobDescriptorSets.data());
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error("Failed to allocate Descriptor Sets!");
+		}
+
+		for (size_t i = 0; i < jobOutputs.size(); i++) {
+			VkDescriptorBufferInfo bufferInfos[2] = {};
+			bufferInfos[0].buffer = slot.inputBuffer;								// Whole batch input
+			bufferInfos[0].offset = 0;
+			bufferInfos[0].range = inputSize;
+			bufferInfos[1].buffer = slot.outputBuffer;								// This job's output region
+			bufferInfos[1].offset = jobOutputs[i].offset;
+			bufferInfos[1].range = jobOutputs[i].size;
+
+			VkWriteDescriptorSet setWrites[2] = {};
+			for (uint32_t binding = 0; binding < 2; binding++) {
+				setWrites[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				setWrites[binding].dstSet = slot.jobDescriptorSets[i];				// Descriptor Set to update
+				setWrites[binding].dstBinding = binding;							// Binding to update (matches binding on layout/shader)
+				setWrites[binding].dstArrayElement = 0;								// Index in array to update
+				setWrites[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;	// Type of descriptor
+				setWrites[binding].descriptorCount = 1;								// Amount to update
+				setWrites[binding].pBufferInfo = &bufferInfos[binding];				// Information about buffer data to bind
+			}
+
+			vkUpdateDescriptorSets(context->getLogicalDevice(), 2, setWrites, 0, nullptr);
+		}
+	}
+}
+
+void ComputeBatchProcessor::LoadBatch(uint64_t batchIndex, uint32_t* pixels) const
+{
+	// Stands in for decoding images from disk: a gradient with hashed noise, deterministic per
+	// (batch, image) so the CPU reference can regenerate exactly the same input
+	uint32_t width = settings.imageWidth;
+	uint32_t height = settings.imageHeight;
+
+	for (uint32_t image = 0; image < settings.imagesPerBatch; image++) {
+		uint32_t seed = static_cast<uint32_t>(batchIndex * settings.imagesPerBatch + image) * 0x9E3779B1u;
+		uint32_t* imagePixels = pixels + static_cast<size_t>(image) * width * height;
+
+		for (uint32_t y = 0; y < height; y++) {
+			for (uint32_t x = 0; x < width; x++) {
+				uint32_t hash = seed ^ (x * 0x85EBCA77u) ^ (y * 0xC2B2AE3Du);
+				hash ^= hash >> 15;
+				hash *= 0x2C1B3C6Du;
+				hash ^= hash >> 12;
+
+				uint32_t r = (x * 255 / width + (hash & 0x1F) + seed) & 0xFF;
+				uint32_t g = (y * 255 / height + ((hash >> 5) & 0x1F)) & 0xFF;
+				uint32_t b = (hash >> 10) & 0xFF;
+				imagePixels[y * width + x] = r | (g << 8) | (b << 16) | 0xFF000000u;
+			}
+		}
+	}
+}
+
+void ComputeBatchProcessor::RecordBatch(BatchSlot& slot)
+{
+	VkCommandBuffer commandBuffer = slot.commandBuffer;
+
+	// Recorded once and submitted many times, so no ONE_TIME_SUBMIT
+	VkCommandBufferBeginInfo bufferBeginInfo = {};
+	bufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+	VkResult result = vkBeginCommandBuffer(commandBuffer, &bufferBeginInfo);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to start recording a Command Buffer!");
+	}
+
+	// -- UPLOAD --
+	VkBufferCopy inputCopy = {};
+	inputCopy.srcOffset = 0;
+	inputCopy.dstOffset = 0;
+	inputCopy.size = inputSize;
+	vkCmdCopyBuffer(commandBuffer, slot.stagingBuffer, slot.inputBuffer, 1, &inputCopy);
+
+	// Histograms accumulate with atomics, so start from zero
+	for (const auto& jobOutput : jobOutputs) {
+		if (jobOutput.type == ComputeJobType::Histogram) {
+			vkCmdFillBuffer(commandBuffer, slot.outputBuffer, jobOutput.offset, jobOutput.size, 0);
+		}
+	}
+
+	VkMemoryBarrier uploadBarrier = {};
+	uploadBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	uploadBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	uploadBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &uploadBarrier, 0, nullptr, 0, nullptr);
+
+	// -- DISPATCH --
+	// Jobs write separate regions, so they can run back to back without barriers between them
+	ComputePushConstants pushConstants = {};
+	pushConstants.width = settings.imageWidth;
+	pushConstants.height = settings.imageHeight;
+
+	for (size_t i = 0; i < jobOutputs.size(); i++) {
+		ComputeJobType job = jobOutputs[i].type;
+
+		// Resize runs one invocation per destination pixel
+		uint32_t invocationsX = job == ComputeJobType::Resize ? settings.imageWidth / 2 : settings.imageWidth;
+		uint32_t invocationsY = job == ComputeJobType::Resize ? settings.imageHeight / 2 : settings.imageHeight;
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, jobPipelines[static_cast<int>(job)]);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &slot.jobDescriptorSets[i], 0, nullptr);
+		vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ComputePushConstants), &pushConstants);
+		vkCmdDispatch(commandBuffer,
+			(invocationsX + COMPUTE_GROUP_SIZE - 1) / COMPUTE_GROUP_SIZE,
+			(invocationsY + COMPUTE_GROUP_SIZE - 1) / COMPUTE_GROUP_SIZE,
+			settings.imagesPerBatch);
+	}
+
+	// -- READ BACK --
+	VkMemoryBarrier dispatchBarrier = {};
+	dispatchBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	dispatchBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	dispatchBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &dispatchBarrier, 0, nullptr, 0, nullptr);
+
+	VkBufferCopy outputCopy = {};
+	outputCopy.srcOffset = 0;
+	outputCopy.dstOffset = 0;
+	outputCopy.size = outputSize;
+	vkCmdCopyBuffer(commandBuffer, slot.outputBuffer, slot.readbackBuffer, 1, &outputCopy);
+
+	// Make the copy visible to the host once the fence signals
+	VkMemoryBarrier readbackBarrier = {};
+	readbackBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	readbackBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	readbackBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &readbackBarrier, 0, nullptr, 0, nullptr);
+
+	result = vkEndCommandBuffer(commandBuffer);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to stop recording a Command Buffer!");
+	}
+}
+
+void ComputeBatchProcessor::SubmitBatch(BatchSlot& slot)
+{
+	vkResetFences(context->getLogicalDevice(), 1, &slot.fence);
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;											// Number of command buffers to submit
+	submitInfo.pCommandBuffers = &slot.commandBuffer;							// Command buffer to submit
+
+	// Nothing to wait on: the fence already guarantees the slot's previous batch is finished
+	VkResult result = vkQueueSubmit(context->getComputeQueue(), 1, &submitInfo, slot.fence);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to submit compute batch to queue!");
+	}
+}
+
+void ComputeBatchProcessor::ReadBackBatch(BatchSlot& slot, ComputeBatchResults& results)
+{
+	using Clock = std::chrono::steady_clock;
+
+	// -- WAIT FOR BATCH --
+	Clock::time_point waitStart = Clock::now();
+	vkWaitForFences(context->getLogicalDevice(), 1, &slot.fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+	Clock::time_point readbackStart = Clock::now();
+	results.waitSeconds += std::chrono::duration<double>(readbackStart - waitStart).count();
+
+	// Cached but not coherent memory may hold stale lines from the last time this slot was read
+	if (!readbackCoherent) {
+		VkMappedMemoryRange range = {};
+		range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		range.memory = slot.readbackMemory;
+		range.offset = 0;
+		range.size = VK_WHOLE_SIZE;
+		vkInvalidateMappedMemoryRanges(context->getLogicalDevice(), 1, &range);
+	}
+
+	// -- CONSUME OUTPUT --
+	// Stands in for encoding/writing results: touch every output word so the readback can't be skipped
+	const uint64_t* words = reinterpret_cast<const uint64_t*>(slot.readbackData);
+	uint64_t checksum = 0;
+	for (VkDeviceSize i = 0; i < outputSize / sizeof(uint64_t); i++) {
+		checksum = (checksum ^ words[i]) * 0x100000001B3ull;
+	}
+	results.checksum ^= checksum + static_cast<uint64_t>(slot.batchIndex);
+
+	if (static_cast<uint64_t>(slot.batchIndex) < settings.verifyBatches) {
+		verifyOutputs.emplace_back(slot.readbackData, slot.readbackData + outputSize);
+	}
+
+	results.imagesProcessed += settings.imagesPerBatch;
+	results.readbackSeconds += std::chrono::duration<double>(Clock::now() - readbackStart).count();
+
+	slot.batchIndex = -1;
+}
+
+uint64_t ComputeBatchProcessor::VerifyBatch(uint64_t batchIndex, const uint8_t* outputs, double& referenceSeconds) const
+{
+	using Clock = std::chrono::steady_clock;
+
+	uint32_t width = settings.imageWidth;
+	uint32_t height = settings.imageHeight;
+
+	std::vector<uint32_t> input(static_cast<size_t>(inputSize / sizeof(uint32_t)));
+	LoadBatch(batchIndex, input.data());
+
+	// Scratch big enough for the largest per-image output
+	std::vector<uint32_t> expected(std::max<size_t>(static_cast<size_t>(width) * height, HISTOGRAM_BINS));
+
+	uint64_t mismatches = 0;
+	for (const auto& jobOutput : jobOutputs) {
+		for (uint32_t image = 0; image < settings.imagesPerBatch; image++) {
+			const uint32_t* source = input.data() + static_cast<size_t>(image) * width * height;
+
+			Clock::time_point referenceStart = Clock::now();
+			switch (jobOutput.type) {
+			case ComputeJobType::ColourConvert:	referenceColourConvert(source, width, height, expected.data());	break;
+			case ComputeJobType::Resize:		referenceResize(source, width, height, expected.data());			break;
+			case ComputeJobType::Histogram:		referenceHistogram(source, width, height, expected.data());		break;
+			default:																								break;
+			}
+			referenceSeconds += std::chrono::duration<double>(Clock::now() - referenceStart).count();
+
+			const uint8_t* actual = outputs + jobOutput.offset + image * jobOutput.bytesPerImage;
+			if (memcmp(actual, expected.data(), static_cast<size_t>(jobOutput.bytesPerImage)) != 0) {
+				if (mismatches == 0) {
+					printf("MISMATCH: %s, batch %llu, image %u\n", computeJobName(jobOutput.type), static_cast<unsigned long long>(batchIndex), image);
+				}
+				mismatches++;
+			}
+		}
+	}
+
+	return mismatches;
+}
+
+VkShaderModule ComputeBatchProcessor::createShaderModule(const std::vector<char>& code)
+{
+	// Shader Module creation information
+	VkShaderModuleCreateInfo shaderModuleCreateInfo = {};
+	shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	shaderModuleCreateInfo.codeSize = code.size();										// Size of code
+	shaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());		// Pointer to code (of uint32_t pointer type)
+
+	VkShaderModule shaderModule;
+	VkResult result = vkCreateShaderModule(context->getLogicalDevice(), &shaderModuleCreateInfo, nullptr, &shaderModule);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a shader module!");
+	}
+
+	return shaderModule;
+}
+
+int runComputeBatchMode(const ComputeBatchSettings& settings, const char* preferredDeviceName)
+{
+	VulkanContext context;
+	ComputeBatchProcessor processor;
+	ComputeBatchResults results;
+
+	try {
+		context.CreateInstance(true);
+		context.CreateComputeDevice(preferredDeviceName);
+
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(context.getPhysicalDevice(), &deviceProperties);
+		printf("Compute batch mode on %s (queue family %d)\n", deviceProperties.deviceName, context.getQueueFamilyIndices().computeFamily);
+
+		processor.init(&context, settings);
+		results = processor.Run();
+	}
+	catch (const std::runtime_error& e) {
+		printf("ERROR: %s\n", e.what());
+		context.CleanUp();
+		return EXIT_FAILURE;
+	}
+
+	context.CleanUp();
+
+	printf("  jobs:");
+	for (size_t i = 0; i < settings.jobs.size(); i++) {
+		printf("%s %s", i == 0 ? "" : ",", computeJobName(settings.jobs[i]));
+	}
+	printf("\n  %u batches x %u images (%ux%u), %d batches in flight\n",
+		settings.batchCount, settings.imagesPerBatch, settings.imageWidth, settings.imageHeight, COMPUTE_BATCHES_IN_FLIGHT);
+	printf("  GPU: %llu images in %.3f s = %.1f images/sec\n",
+		static_cast<unsigned long long>(results.imagesProcessed), results.seconds, results.imagesPerSecond);
+	printf("  CPU time: load %.3f s, readback %.3f s, blocked on GPU %.3f s\n",
+		results.loadSeconds, results.readbackSeconds, results.waitSeconds);
+
+	if (results.imagesVerified > 0) {
+		printf("  CPU reference: %llu images verified, %llu mismatches, %.1f images/sec\n",
+			static_cast<unsigned long long>(results.imagesVerified), static_cast<unsigned long long>(results.mismatches), results.referenceImagesPerSecond);
+	}
+	printf("  checksum: %016llx\n", static_cast<unsigned long long>(results.checksum));
+
+	return results.mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
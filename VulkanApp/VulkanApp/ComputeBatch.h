@@ -0,0 +1,137 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdexcept>
+#include <vector>
+#include <string>
+#include <cstring>
+
+#include "Utilities.h"
+#include "VulkanContext.h"
+
+// Jobs run over every image of a batch, each is one compute pipeline
+enum class ComputeJobType {
+	ColourConvert,				// RGBA8 -> greyscale
+	Resize,						// Half-size 2x2 box downscale
+	Histogram,					// 256 bin luma histogram
+	Count
+};
+
+const char* computeJobName(ComputeJobType job);
+
+struct ComputeBatchSettings {
+	uint32_t imageWidth = 512;
+	uint32_t imageHeight = 512;
+	uint32_t imagesPerBatch = 16;
+	uint32_t batchCount = 64;
+	std::vector<ComputeJobType> jobs = { ComputeJobType::ColourConvert, ComputeJobType::Resize, ComputeJobType::Histogram };
+	uint32_t verifyBatches = 2;				// Batches checked against the CPU reference after the timed run (0 to skip)
+};
+
+struct ComputeBatchResults {
+	uint64_t imagesProcessed = 0;
+	double seconds = 0.0;
+	double imagesPerSecond = 0.0;
+
+	// Where the CPU spent the run: time blocked on fences is time the pipeline didn't hide
+	double loadSeconds = 0.0;
+	double readbackSeconds = 0.0;
+	double waitSeconds = 0.0;
+
+	// CPU reference, run on the verified batches only
+	uint64_t imagesVerified = 0;
+	uint64_t mismatches = 0;
+	double referenceImagesPerSecond = 0.0;
+
+	uint64_t checksum = 0;					// Over every output, so no readback can be skipped
+};
+
+// Runs a queue of compute jobs over batches of images on a compute-only VulkanContext.
+// COMPUTE_BATCHES_IN_FLIGHT slots each own staging, device and readback buffers, so while the GPU
+// uploads, dispatches and copies back one batch, the CPU loads the next and reads back the previous.
+class ComputeBatchProcessor
+{
+public:
+	ComputeBatchProcessor();
+	~ComputeBatchProcessor();
+
+	void init(VulkanContext* newContext, const ComputeBatchSettings& newSettings);
+	ComputeBatchResults Run();
+
+private:
+	struct BatchSlot {
+		// Host -> device
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingMemory;
+		uint32_t* stagingData;
+
+		// Device local input and job outputs
+		VkBuffer inputBuffer;
+		VkDeviceMemory inputMemory;
+		VkBuffer outputBuffer;
+		VkDeviceMemory outputMemory;
+
+		// Device -> host
+		VkBuffer readbackBuffer;
+		VkDeviceMemory readbackMemory;
+		uint8_t* readbackData;
+
+		VkCommandBuffer commandBuffer;
+		VkFence fence;
+		std::vector<VkDescriptorSet> jobDescriptorSets;		// One per job, pointing at its output region
+		int64_t batchIndex = -1;							// Batch being processed in this slot, -1 if idle
+	};
+
+	struct JobOutput {
+		ComputeJobType type;
+		VkDeviceSize offset;								// Offset of this job's region in the output buffer
+		VkDeviceSize size;									// Bytes for the whole batch
+		VkDeviceSize bytesPerImage;
+	};
+
+	VulkanContext* context = nullptr;
+	ComputeBatchSettings settings;
+
+	// - Pipelines
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkPipelineLayout pipelineLayout;
+	VkPipeline jobPipelines[static_cast<int>(ComputeJobType::Count)] = {};
+
+	// - Descriptors
+	VkDescriptorPool descriptorPool;
+
+	// - Batches
+	std::vector<BatchSlot> batchSlots;
+	std::vector<JobOutput> jobOutputs;
+	VkDeviceSize inputSize = 0;
+	VkDeviceSize outputSize = 0;
+	bool readbackCoherent = true;
+	std::vector<std::vector<uint8_t>> verifyOutputs;		// Copies of the first verifyBatches outputs, checked once timing is done
+
+	// Vulkan Functions
+	// - Create Functions
+	void CreateDescriptorSetLayout();
+	void CreatePipelineLayout();
+	void CreateJobPipelines();
+	void CreateBatchSlots();
+	void CreateDescriptorPool();
+	void CreateDescriptorSets();
+
+	// - Batch Functions
+	void LoadBatch(uint64_t batchIndex, uint32_t* pixels) const;
+	void RecordBatch(BatchSlot& slot);
+	void SubmitBatch(BatchSlot& slot);
+	void ReadBackBatch(BatchSlot& slot, ComputeBatchResults& results);
+
+	// - Reference Functions
+	uint64_t VerifyBatch(uint64_t batchIndex, const uint8_t* outputs, double& referenceSeconds) const;
+
+	// - Support Functions
+	VkShaderModule createShaderModule(const std::vector<char>& code);
+};
+
+// Compute-only entry point: brings up a headless context (optionally on a device whose name contains
+// preferredDeviceName, e.g. "llvmpipe"), runs the batches and prints throughput and correctness
+int runComputeBatchMode(const ComputeBatchSettings& settings, const char* preferredDeviceName);
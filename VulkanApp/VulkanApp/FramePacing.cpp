@@ -0,0 +1,106 @@
+#include "FramePacing.h"
+
+#include <cstdio>
+#include <cmath>
+#include <thread>
+#include <algorithm>
+
+FrameLimiter::FrameLimiter()
+{
+	nextFrame = Clock::now();
+}
+
+void FrameLimiter::setTargetFrameRate(double framesPerSecond)
+{
+	targetFrameRate = framesPerSecond;
+
+	if (framesPerSecond > 0.0) {
+		frameDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond));
+	}
+	else {
+		frameDuration = Clock::duration::zero();
+	}
+
+	nextFrame = Clock::now();
+}
+
+void FrameLimiter::Wait()
+{
+	if (frameDuration == Clock::duration::zero()) {
+		return;
+	}
+
+	// Sleep can overshoot by a scheduler tick, so leave the last couple of milliseconds to a spin
+	const Clock::duration spinThreshold = std::chrono::milliseconds(2);
+
+	Clock::time_point now = Clock::now();
+	if (nextFrame - now > spinThreshold) {
+		std::this_thread::sleep_for(nextFrame - now - spinThreshold);
+	}
+
+	while (Clock::now() < nextFrame) {
+		std::this_thread::yield();
+	}
+
+	// Schedule from the deadline rather than from now so the rate doesn't drift,
+	// unless more than a whole frame was missed, in which case don't try to catch up
+	now = Clock::now();
+	nextFrame += frameDuration;
+	if (nextFrame < now) {
+		nextFrame = now + frameDuration;
+	}
+}
+
+void FramePacingStats::addFrameTime(double seconds)
+{
+	frameCount++;
+	double delta = seconds - meanFrameTime;
+	meanFrameTime += delta / static_cast<double>(frameCount);
+	frameTimeM2 += delta * (seconds - meanFrameTime);
+}
+
+void FramePacingStats::addLatency(double seconds)
+{
+	latencyCount++;
+	latencySum += seconds;
+	maxLatency = std::max(maxLatency, seconds);
+}
+
+void FramePacingStats::reset()
+{
+	*this = FramePacingStats();
+}
+
+double FramePacingStats::getFrameTimeVariance() const
+{
+	if (frameCount < 2) {
+		return 0.0;
+	}
+
+	return frameTimeM2 / static_cast<double>(frameCount - 1);
+}
+
+double FramePacingStats::getMeanLatency() const
+{
+	if (latencyCount == 0) {
+		return 0.0;
+	}
+
+	return latencySum / static_cast<double>(latencyCount);
+}
+
+void FramePacingStats::print(const char* label) const
+{
+	if (frameCount == 0) {
+		return;
+	}
+
+	printf("%-14s frames: %8llu | frame time: %7.3f ms (std dev %6.3f ms, variance %8.4f ms^2) | input-to-present: %7.3f ms avg, %7.3f ms max\n",
+		label,
+		static_cast<unsigned long long>(frameCount),
+		meanFrameTime * 1000.0,
+		std::sqrt(getFrameTimeVariance()) * 1000.0,
+		getFrameTimeVariance() * 1000.0 * 1000.0,
+		getMeanLatency() * 1000.0,
+		maxLatency * 1000.0);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// CPU-side frame rate cap. Sleeps for most of the remaining frame time, then spins for the last
+// part so the wake-up isn't at the mercy of the OS scheduler granularity.
+class FrameLimiter
+{
+public:
+	FrameLimiter();
+
+	void setTargetFrameRate(double framesPerSecond);
+	double getTargetFrameRate() const { return targetFrameRate; }
+
+	// Blocks until the next frame is due. Returns immediately if unlimited
+	void Wait();
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	double targetFrameRate = 0.0;
+	Clock::duration frameDuration = Clock::duration::zero();
+	Clock::time_point nextFrame;
+};
+
+// Running frame time and input-to-present latency statistics for one present mode
+class FramePacingStats
+{
+public:
+	void addFrameTime(double seconds);
+	void addLatency(double seconds);
+	void reset();
+
+	uint64_t getFrameCount() const { return frameCount; }
+	double getMeanFrameTime() const { return meanFrameTime; }
+	double getFrameTimeVariance() const;
+	uint64_t getLatencyCount() const { return latencyCount; }
+	double getMeanLatency() const;
+	double getMaxLatency() const { return maxLatency; }
+
+	void print(const char* label) const;
+
+private:
+	// Welford's online algorithm, so variance is stable over long runs
+	uint64_t frameCount = 0;
+	double meanFrameTime = 0.0;
+	double frameTimeM2 = 0.0;
+
+	uint64_t latencyCount = 0;
+	double latencySum = 0.0;
+	double maxLatency = 0.0;
+};
@@ -0,0 +1,109 @@
+#include "ObjectLifetimes.h"
+
+#include <cstdio>
+
+void DeletionQueue::push(std::function<void()>&& destroy)
+{
+	deletors.push_back(std::move(destroy));
+}
+
+void DeletionQueue::flush()
+{
+	// Reverse order, so objects are destroyed before whatever they were created from
+	for (auto it = deletors.rbegin(); it != deletors.rend(); ++it) {
+		(*it)();
+	}
+
+	deletors.clear();
+}
+
+ObjectLifetimes::ObjectLifetimes()
+{
+}
+
+ObjectLifetimes::~ObjectLifetimes()
+{
+}
+
+void ObjectLifetimes::init(VkDevice logicalDevice, uint32_t framesInFlight)
+{
+	this->logicalDevice = logicalDevice;
+	this->framesInFlight = framesInFlight;
+	currentFrame = 0;
+	active = true;
+}
+
+void ObjectLifetimes::BeginFrame(uint64_t frameNumber)
+{
+	currentFrame = frameNumber;
+
+	// Fence for this slot was last signalled by frame (frameNumber - framesInFlight), so it and everything before it is done
+	if (frameNumber < framesInFlight) {
+		return;
+	}
+
+	uint64_t completedFrame = frameNumber - framesInFlight;
+	while (!pending.empty() && pending.front().retireFrame <= completedFrame) {
+		pending.front().destroy();
+		pending.pop_front();
+	}
+}
+
+void ObjectLifetimes::Retire(std::function<void()>&& destroy)
+{
+	if (!active) {
+#ifndef NDEBUG
+		printf("WARNING: Vulkan object released after shutdown, it was never destroyed\n");
+#endif
+		return;
+	}
+
+	PendingDestroy entry;
+	entry.retireFrame = currentFrame;
+	entry.destroy = std::move(destroy);
+	pending.push_back(std::move(entry));
+}
+
+void ObjectLifetimes::CleanUp()
+{
+	for (auto& entry : pending) {
+		entry.destroy();
+	}
+
+	pending.clear();
+
+	// Anything still tracked is owned by a handle that was never released
+	ReportLeaks();
+	active = false;
+}
+
+void ObjectLifetimes::ReportLeaks() const
+{
+#ifndef NDEBUG
+	if (liveObjects.empty()) {
+		return;
+	}
+
+	printf("WARNING: %zu Vulkan object(s) still alive at shutdown:\n", liveObjects.size());
+	for (const auto& liveObject : liveObjects) {
+		printf("  %s 0x%llx (created in frame %llu)\n",
+			liveObject.first.first,
+			static_cast<unsigned long long>(liveObject.first.second),
+			static_cast<unsigned long long>(liveObject.second));
+	}
+#endif
+}
+
+void ObjectLifetimes::Track(const char* typeName, uint64_t handleValue)
+{
+#ifndef NDEBUG
+	liveObjects[std::make_pair(typeName, handleValue)] = currentFrame;
+#endif
+}
+
+void ObjectLifetimes::Untrack(const char* typeName, uint64_t handleValue)
+{
+#ifndef NDEBUG
+	liveObjects.erase(std::make_pair(typeName, handleValue));
+#endif
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <map>
+#include <utility>
+#include <cstring>
+
+// List of destroy calls run in reverse order of registration.
+// Objects created in init push their destroy call straight after creation, so flushing tears
+// everything down in the reverse of the order it was built in.
+class DeletionQueue
+{
+public:
+	void push(std::function<void()>&& destroy);
+	void flush();
+
+	size_t size() const { return deletors.size(); }
+
+private:
+	std::vector<std::function<void()>> deletors;
+};
+
+template<typename T>
+class UniqueHandle;
+
+// Owns GPU objects released at runtime. Retired objects are kept until every frame that could
+// have used them has finished on the GPU, so nothing needs vkDeviceWaitIdle to be freed mid-run.
+class ObjectLifetimes
+{
+public:
+	ObjectLifetimes();
+	~ObjectLifetimes();
+
+	void init(VkDevice logicalDevice, uint32_t framesInFlight);
+
+	// Call after waiting on the fence of frameNumber's slot: destroys everything retired by frames that have now completed
+	void BeginFrame(uint64_t frameNumber);
+
+	// Defer a destroy call until the current frame has retired
+	void Retire(std::function<void()>&& destroy);
+
+	// Destroy everything still pending and report leaks, device must be idle
+	void CleanUp();
+
+	// Print objects wrapped in a UniqueHandle that were never released (debug builds only)
+	void ReportLeaks() const;
+
+	template<typename T>
+	UniqueHandle<T> Make(T handle, const char* typeName, void (VKAPI_PTR* destroy)(VkDevice, T, const VkAllocationCallbacks*));
+
+	VkDevice getDevice() const { return logicalDevice; }
+	size_t getPendingCount() const { return pending.size(); }
+
+private:
+	template<typename T> friend class UniqueHandle;
+
+	struct PendingDestroy {
+		uint64_t retireFrame;					// Last frame that may still be using the object
+		std::function<void()> destroy;
+	};
+
+	VkDevice logicalDevice = VK_NULL_HANDLE;
+	uint32_t framesInFlight = 0;
+	uint64_t currentFrame = 0;
+	bool active = false;
+	std::deque<PendingDestroy> pending;			// Ordered by retireFrame, since frames only move forwards
+
+	// - Leak Tracking
+	void Track(const char* typeName, uint64_t handleValue);
+	void Untrack(const char* typeName, uint64_t handleValue);
+
+#ifndef NDEBUG
+	std::map<std::pair<const char*, uint64_t>, uint64_t> liveObjects;	// (type, handle) -> frame it was created in
+#endif
+};
+
+// Move-only owner of a device-level Vulkan handle. Releasing it (reset, reassignment or going out
+// of scope) retires the handle to ObjectLifetimes rather than destroying it immediately.
+template<typename T>
+class UniqueHandle
+{
+public:
+	using DestroyFunction = void (VKAPI_PTR*)(VkDevice, T, const VkAllocationCallbacks*);
+
+	UniqueHandle() {}
+	UniqueHandle(ObjectLifetimes* owner, T handle, const char* typeName, DestroyFunction destroy)
+		: owner(owner), handle(handle), typeName(typeName), destroy(destroy) {}
+
+	~UniqueHandle() { reset(); }
+
+	UniqueHandle(const UniqueHandle&) = delete;
+	UniqueHandle& operator=(const UniqueHandle&) = delete;
+
+	UniqueHandle(UniqueHandle&& other) noexcept { *this = std::move(other); }
+	UniqueHandle& operator=(UniqueHandle&& other) noexcept {
+		if (this != &other) {
+			reset();
+			owner = other.owner;
+			handle = other.handle;
+			typeName = other.typeName;
+			destroy = other.destroy;
+			other.handle = VK_NULL_HANDLE;
+		}
+		return *this;
+	}
+
+	T get() const { return handle; }
+	operator T() const { return handle; }
+	explicit operator bool() const { return handle != VK_NULL_HANDLE; }
+
+	void reset() {
+		if (handle == VK_NULL_HANDLE || owner == nullptr) {
+			return;
+		}
+
+		// Copy what the deferred call needs, this wrapper may be long gone by the time it runs
+		ObjectLifetimes* lifetimes = owner;
+		VkDevice device = owner->getDevice();
+		T retiredHandle = handle;
+		const char* retiredType = typeName;
+		DestroyFunction destroyFunction = destroy;
+
+		owner->Retire([lifetimes, device, retiredHandle, retiredType, destroyFunction]() {
+			destroyFunction(device, retiredHandle, nullptr);
+			lifetimes->Untrack(retiredType, handleValue(retiredHandle));
+		});
+
+		handle = VK_NULL_HANDLE;
+	}
+
+	static uint64_t handleValue(T value) {
+		// Non-dispatchable handles are pointers on 64-bit and uint64_t on 32-bit, copy bytes to cover both
+		uint64_t result = 0;
+		memcpy(&result, &value, sizeof(T));
+		return result;
+	}
+
+private:
+	ObjectLifetimes* owner = nullptr;
+	T handle = VK_NULL_HANDLE;
+	const char* typeName = nullptr;
+	DestroyFunction destroy = nullptr;
+};
+
+template<typename T>
+UniqueHandle<T> ObjectLifetimes::Make(T handle, const char* typeName, void (VKAPI_PTR* destroy)(VkDevice, T, const VkAllocationCallbacks*))
+{
+	Track(typeName, UniqueHandle<T>::handleValue(handle));
+	return UniqueHandle<T>(this, handle, typeName, destroy);
+}
@@ -0,0 +1,85 @@
+#include "PresentPolicy.h"
+
+const char* presentLatencyModeName(PresentLatencyMode mode)
+{
+	switch (mode) {
+	case PresentLatencyMode::LowLatency:	return "Low Latency";
+	case PresentLatencyMode::Throughput:	return "Throughput";
+	case PresentLatencyMode::PowerSaving:	return "Power Saving";
+	default:								return "Unknown";
+	}
+}
+
+PresentPolicy::PresentPolicy()
+{
+	frameRateLimits[static_cast<int>(PresentLatencyMode::LowLatency)] = 0.0;		// Paced by present wait instead
+	frameRateLimits[static_cast<int>(PresentLatencyMode::Throughput)] = 0.0;
+	frameRateLimits[static_cast<int>(PresentLatencyMode::PowerSaving)] = 30.0;
+}
+
+void PresentPolicy::setFrameRateLimit(PresentLatencyMode limitMode, double framesPerSecond)
+{
+	frameRateLimits[static_cast<int>(limitMode)] = std::max(0.0, framesPerSecond);
+}
+
+PresentPolicySettings PresentPolicy::choose(const SwapChainDetails& swapChainDetails) const
+{
+	const VkSurfaceCapabilitiesKHR& capabilities = swapChainDetails.surfaceCapabilities;
+
+	PresentPolicySettings settings = {};
+	settings.targetFrameRate = frameRateLimits[static_cast<int>(mode)];
+
+	switch (mode) {
+	case PresentLatencyMode::LowLatency:
+		// MAILBOX always shows the newest frame without tearing, IMMEDIATE is next best.
+		// Only one present is allowed to be pending, so input is sampled as late as possible
+		settings.presentMode = choosePresentMode(swapChainDetails.presentationModes, { VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR });
+		settings.imageCount = settings.presentMode == VK_PRESENT_MODE_MAILBOX_KHR ? capabilities.minImageCount + 1 : capabilities.minImageCount;
+		settings.maxQueuedPresents = 1;
+		break;
+
+	case PresentLatencyMode::Throughput:
+		// Never block on the display, and keep an extra image so the GPU always has something to render to
+		settings.presentMode = choosePresentMode(swapChainDetails.presentationModes, { VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR });
+		settings.imageCount = capabilities.minImageCount + 2;
+		settings.maxQueuedPresents = 0;
+		break;
+
+	case PresentLatencyMode::PowerSaving:
+	default:
+		// FIFO is always supported and never renders frames that won't be shown
+		settings.presentMode = VK_PRESENT_MODE_FIFO_KHR;
+		settings.imageCount = capabilities.minImageCount + 1;
+		settings.maxQueuedPresents = 2;
+		break;
+	}
+
+	settings.imageCount = clampImageCount(capabilities, settings.imageCount);
+
+	return settings;
+}
+
+VkPresentModeKHR PresentPolicy::choosePresentMode(const std::vector<VkPresentModeKHR>& presentationModes, const std::vector<VkPresentModeKHR>& preferred) const
+{
+	// Take the first preferred mode the surface supports
+	for (VkPresentModeKHR preferredMode : preferred) {
+		if (std::find(presentationModes.begin(), presentationModes.end(), preferredMode) != presentationModes.end()) {
+			return preferredMode;
+		}
+	}
+
+	// If can't find, use FIFO (always available)
+	return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+uint32_t PresentPolicy::clampImageCount(const VkSurfaceCapabilitiesKHR& surfaceCapabilities, uint32_t imageCount) const
+{
+	imageCount = std::max(imageCount, surfaceCapabilities.minImageCount);
+
+	// If maxImageCount is 0, then limitless
+	if (surfaceCapabilities.maxImageCount > 0 && surfaceCapabilities.maxImageCount < imageCount) {
+		imageCount = surfaceCapabilities.maxImageCount;
+	}
+
+	return imageCount;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <vector>
+#include <algorithm>
+
+#include "Utilities.h"
+
+// What the swapchain should be tuned for
+enum class PresentLatencyMode {
+	LowLatency,			// Shortest input-to-present time, frames are paced against the display
+	Throughput,			// Highest frame rate, tearing or discarded frames allowed
+	PowerSaving,		// Vsync plus a frame rate cap, the GPU idles as much as possible
+	Count
+};
+
+const char* presentLatencyModeName(PresentLatencyMode mode);
+
+// Swapchain and pacing settings picked for a latency mode
+struct PresentPolicySettings {
+	VkPresentModeKHR presentMode;
+	uint32_t imageCount;				// minImageCount for swapchain creation
+	uint32_t maxQueuedPresents;			// Presents allowed to be pending before vkWaitForPresentKHR blocks (0 = never wait)
+	double targetFrameRate;				// CPU frame limiter target in frames per second (0 = unlimited)
+};
+
+class PresentPolicy
+{
+public:
+	PresentPolicy();
+
+	void setMode(PresentLatencyMode newMode) { mode = newMode; }
+	PresentLatencyMode getMode() const { return mode; }
+
+	// Frame rate cap used by the CPU limiter in the given mode (0 = unlimited)
+	void setFrameRateLimit(PresentLatencyMode limitMode, double framesPerSecond);
+
+	PresentPolicySettings choose(const SwapChainDetails& swapChainDetails) const;
+
+private:
+	PresentLatencyMode mode = PresentLatencyMode::LowLatency;
+	double frameRateLimits[static_cast<int>(PresentLatencyMode::Count)];
+
+	// - Support Functions
+	VkPresentModeKHR choosePresentMode(const std::vector<VkPresentModeKHR>& presentationModes, const std::vector<VkPresentModeKHR>& preferred) const;
+	uint32_t clampImageCount(const VkSurfaceCapabilitiesKHR& surfaceCapabilities, uint32_t imageCount) const;
+};
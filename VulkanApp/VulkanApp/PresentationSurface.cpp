@@ -0,0 +1,386 @@
+#include "PresentationSurface.h"
+
+PresentationSurface::PresentationSurface()
+{
+}
+
+PresentationSurface::~PresentationSurface()
+{
+}
+
+void PresentationSurface::init(VulkanContext* newContext, GLFWwindow* newWindow, VkSurfaceKHR newSurface, const PresentPolicy& presentPolicy)
+{
+	context = newContext;
+	window = newWindow;
+	surface = newSurface;
+
+	// Device was picked for the first window, so make sure this one can be presented to from the same queue
+	if (!context->CheckSurfaceSupport(surface)) {
+		throw std::runtime_error("Presentation queue can't present to this window's surface!");
+	}
+
+	CreateSwapChain(presentPolicy);
+	CreateSynchronisation();
+}
+
+void PresentationSurface::CleanUp()
+{
+	// Release everything to the frame retirement queue, so a window can be removed without stalling frames in flight.
+	// The swapchain's last presents aren't covered by frame retirement, so wait for those first
+	WaitForQueuedPresents();
+
+	swapChainImages.clear();
+	swapChain.reset();
+	clearRenderPass.reset();
+	imageAvailable.clear();
+
+	// Surface is instance-level so can't be a UniqueHandle, but must still outlive the swapchain: retire it after it
+	VkInstance instance = context->getInstance();
+	VkSurfaceKHR retiredSurface = surface;
+	context->getLifetimes().Retire([instance, retiredSurface]() {
+		vkDestroySurfaceKHR(instance, retiredSurface, nullptr);
+	});
+
+	surface = VK_NULL_HANDLE;
+}
+
+void PresentationSurface::RecreateSwapChain(const PresentPolicy& presentPolicy)
+{
+	// A minimised window has no extent to create a swapchain with, keep skipping its frames until it is restored
+	SwapChainDetails swapChainDetails = context->getSwapChainDetails(surface);
+	if (swapChainDetails.surfaceCapabilities.currentExtent.width == 0 || swapChainDetails.surfaceCapabilities.currentExtent.height == 0) {
+		return;
+	}
+
+	// Old image views and swapchain may still be used by frames in flight, so they're retired rather
+	// than destroyed: no need to stall the device. Only its queued presents have to be waited for
+	WaitForQueuedPresents();
+
+	CreateSwapChain(presentPolicy);
+
+	// Present ids belong to a swapchain, so the new one starts again
+	presentId = 0;
+	lastMeasuredPresentId = 0;
+	presentWaitResult = VK_SUCCESS;
+}
+
+VkResult PresentationSurface::AcquireNextImage(int frame)
+{
+	// Get index of next image to be drawn to, and signal semaphore when ready to be drawn to
+	return vkAcquireNextImageKHR(context->getLogicalDevice(), swapChain, std::numeric_limits<uint64_t>::max(), imageAvailable[frame], VK_NULL_HANDLE, &imageIndex);
+}
+
+uint64_t PresentationSurface::NextPresentId(std::chrono::steady_clock::time_point inputSampleTime)
+{
+	presentId++;
+	presentInputTimes[presentId % PRESENT_HISTORY_SIZE] = inputSampleTime;
+
+	return presentId;
+}
+
+void PresentationSurface::WaitForPendingPresents(uint32_t maxQueuedPresents)
+{
+	// Swapchain is about to be recreated, its presents won't complete
+	if (presentWaitResult != VK_SUCCESS) {
+		return;
+	}
+
+	// Block until at most maxQueuedPresents - 1 presents are still waiting for the display,
+	// so the input sampled after this returns is shown as soon as possible
+	if (maxQueuedPresents > 0 && presentId + 1 > maxQueuedPresents) {
+		uint64_t waitId = presentId + 1 - maxQueuedPresents;
+		VkResult result = context->getWaitForPresentFunction()(context->getLogicalDevice(), swapChain, waitId, 1000000000ull);
+
+		// Timeout (e.g. minimised) just means nothing more to wait for this frame.
+		// Anything else (out of date, device lost) is left for draw() to handle before it acquires
+		if (result != VK_SUCCESS && result != VK_TIMEOUT) {
+			presentWaitResult = result;
+		}
+	}
+}
+
+void PresentationSurface::WaitForQueuedPresents()
+{
+	// Retired objects are destroyed once the frame's fence signals, but that only covers its command buffer.
+	// The vkQueuePresentKHR submitted after it (and its wait on renderFinished) can still be pending then,
+	// and destroying a swapchain with a present in flight is invalid. Only happens on a mode switch or window removal
+	if (!swapChain) {
+		return;
+	}
+
+	// Present wait returns once the last present has reached the display, so every earlier one has too.
+	// Time out in case it never will (e.g. minimised), and fall back to the queue going idle
+	if (context->isPresentWaitSupported() && presentId > 0) {
+		VkResult result = context->getWaitForPresentFunction()(context->getLogicalDevice(), swapChain, presentId, 1000000000ull);
+		if (result == VK_SUCCESS) {
+			return;
+		}
+	}
+
+	vkQueueWaitIdle(context->getPresentationQueue());
+}
+
+void PresentationSurface::MeasurePresentLatency(FramePacingStats& stats)
+{
+	// Swapchain is about to be recreated, its presents won't complete
+	if (presentWaitResult != VK_SUCCESS) {
+		return;
+	}
+
+	// Record every present that has reached the display since last frame (resolution is one frame)
+	std::chrono::steady_clock::time_point measuredAt = std::chrono::steady_clock::now();
+	while (lastMeasuredPresentId < presentId) {
+		uint64_t measureId = lastMeasuredPresentId + 1;
+
+		// Input time for this id has already been overwritten, nothing to measure
+		if (presentId - measureId >= PRESENT_HISTORY_SIZE) {
+			lastMeasuredPresentId = measureId;
+			continue;
+		}
+
+		VkResult result = context->getWaitForPresentFunction()(context->getLogicalDevice(), swapChain, measureId, 0);
+		if (result != VK_SUCCESS) {
+			if (result != VK_TIMEOUT) {
+				presentWaitResult = result;
+			}
+			break;
+		}
+
+		stats.addLatency(std::chrono::duration<double>(measuredAt - presentInputTimes[measureId % PRESENT_HISTORY_SIZE]).count());
+		lastMeasuredPresentId = measureId;
+	}
+}
+
+void PresentationSurface::CreateSwapChain(const PresentPolicy& presentPolicy)
+{
+	// Get swao chain details so we can pick best settings
+	SwapChainDetails swapChainDetails = context->getSwapChainDetails(surface);
+	
+	// Find optimal surface values for our swap chain
+	VkSurfaceFormatKHR surfaceFormat = chooseBestSurfaceFormat(swapChainDetails.formats);
+	VkExtent2D extent = chooseSwapExtent(swapChainDetails.surfaceCapabilities);
+
+	// Present mode, image count and pacing come from the current latency mode
+	presentSettings = presentPolicy.choose(swapChainDetails);
+	VkPresentModeKHR presentMode = presentSettings.presentMode;
+	uint32_t imageCount = presentSettings.imageCount;
+
+	// Creation information for swap chain
+	VkSwapchainCreateInfoKHR swapChainCreateInfo = {};
+	swapChainCreateInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+	swapChainCreateInfo.surface = surface;
+	swapChainCreateInfo.imageFormat = surfaceFormat.format;										// Swapchain format
+	swapChainCreateInfo.imageColorSpace = surfaceFormat.colorSpace;								// Swapchain colour space
+	swapChainCreateInfo.presentMode = presentMode;												// Swapchain presentation mode
+	swapChainCreateInfo.imageExtent = extent;													// Swapchain image extents
+	swapChainCreateInfo.minImageCount = imageCount;												// minimum images in swapchain
+	swapChainCreateInfo.imageArrayLayers = 1;													// Number of layers for each image in chain
+	swapChainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;						// What attachment images will be used as
+	swapChainCreateInfo.preTransform = swapChainDetails.surfaceCapabilities.currentTransform;	// Transform to perform on the swapchain
+	swapChainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;						// How to handle blending images with external graphics(e.g. other windows)
+	swapChainCreateInfo.clipped = VK_TRUE;
+
+	// Cleared directly with vkCmdClearColorImage where the surface allows it, otherwise with a render pass load op
+	bool clearWithTransfer = (swapChainDetails.surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) != 0;
+	if (clearWithTransfer) {
+		swapChainCreateInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	}
+
+	// Get Queue Family Indices
+	QueueFamilyIndices indices = context->getQueueFamilyIndices();
+
+	// If graphics and presentation families are different, then swapchain must let iamges be shared between families
+	if (indices.graphicsFamily != indices.presentationFamily) {
+
+		uint32_t queueFamilyIndices[] = {
+			(uint32_t)indices.graphicsFamily,
+			(uint32_t)indices.presentationFamily
+		};
+
+		swapChainCreateInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;			// Image share handling
+		swapChainCreateInfo.queueFamilyIndexCount = 2;								// Number of queue to share images between
+		swapChainCreateInfo.pQueueFamilyIndices = queueFamilyIndices;				// Array of queues to share between
+	}
+	else {
+		swapChainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		swapChainCreateInfo.queueFamilyIndexCount = 0;
+		swapChainCreateInfo.pQueueFamilyIndices = nullptr;
+	}
+
+	// Recreating lets the driver hand resources over from the old swapchain
+	swapChainCreateInfo.oldSwapchain = swapChain;
+
+	// The old swapchain is retired by the driver even if this fails, in which case acquiring from it returns
+	// VK_ERROR_OUT_OF_DATE_KHR and draw() tries again. Build everything into locals so the members are untouched until then
+	VkSwapchainKHR newSwapChainHandle;
+	VkResult result = vkCreateSwapchainKHR(context->getLogicalDevice(), &swapChainCreateInfo, nullptr, &newSwapChainHandle);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create swapchain");
+	}
+	UniqueHandle<VkSwapchainKHR> newSwapChain = context->getLifetimes().Make(newSwapChainHandle, "VkSwapchainKHR", vkDestroySwapchainKHR);
+
+	UniqueHandle<VkRenderPass> newClearRenderPass;
+	if (!clearWithTransfer) {
+		newClearRenderPass = CreateClearRenderPass(surfaceFormat.format);
+	}
+
+	// Get swap chain images (first count, then values)
+	uint32_t swapChainImageCount;
+	vkGetSwapchainImagesKHR(context->getLogicalDevice(), newSwapChain, &swapChainImageCount, nullptr);
+	std::vector<VkImage> images(swapChainImageCount);
+	vkGetSwapchainImagesKHR(context->getLogicalDevice(), newSwapChain, &swapChainImageCount, images.data());
+
+	std::vector<SwapchainImage> newSwapChainImages;
+	for (VkImage image : images) {
+		// Store image handle
+		SwapchainImage swapChainImage = {};
+		swapChainImage.image = image;
+		swapChainImage.imageView = context->getLifetimes().Make(context->createImageView(image, surfaceFormat.format, VK_IMAGE_ASPECT_COLOR_BIT), "VkImageView", vkDestroyImageView);
+
+		// Render pass clear needs a framebuffer around each image
+		if (newClearRenderPass) {
+			VkImageView attachment = swapChainImage.imageView;
+
+			VkFramebufferCreateInfo framebufferCreateInfo = {};
+			framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+			framebufferCreateInfo.renderPass = newClearRenderPass;						// Render pass layout the framebuffer will be used with
+			framebufferCreateInfo.attachmentCount = 1;
+			framebufferCreateInfo.pAttachments = &attachment;							// List of attachments (1:1 with render pass)
+			framebufferCreateInfo.width = extent.width;
+			framebufferCreateInfo.height = extent.height;
+			framebufferCreateInfo.layers = 1;
+
+			VkFramebuffer framebuffer;
+			result = vkCreateFramebuffer(context->getLogicalDevice(), &framebufferCreateInfo, nullptr, &framebuffer);
+			if (result != VK_SUCCESS) {
+				throw std::runtime_error("Failed to create a Framebuffer!");
+			}
+			swapChainImage.framebuffer = context->getLifetimes().Make(framebuffer, "VkFramebuffer", vkDestroyFramebuffer);
+		}
+
+		// Add to swapchain image list
+		newSwapChainImages.push_back(std::move(swapChainImage));
+	}
+
+	// Replacing the handles retires the old framebuffers, image views, render pass and swapchain (if any) until
+	// frames using them are done, RecreateSwapChain has already waited for its presents
+	swapChainImages = std::move(newSwapChainImages);
+	clearRenderPass = std::move(newClearRenderPass);
+	swapChain = std::move(newSwapChain);
+
+	// Store for later reference
+	swapChainImageFormat = surfaceFormat.format;
+	swapChainExtent = extent;
+}
+
+UniqueHandle<VkRenderPass> PresentationSurface::CreateClearRenderPass(VkFormat format)
+{
+	// Single colour attachment, cleared on load and handed straight to presentation
+	VkAttachmentDescription colourAttachment = {};
+	colourAttachment.format = format;
+	colourAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	colourAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;							// Clear when the render pass begins
+	colourAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;						// Keep the clear for presentation
+	colourAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	colourAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	colourAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;					// Previous contents are discarded
+	colourAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;				// Ready to present once the render pass ends
+
+	VkAttachmentReference colourAttachmentReference = {};
+	colourAttachmentReference.attachment = 0;
+	colourAttachmentReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 1;
+	subpass.pColorAttachments = &colourAttachmentReference;
+
+	// The clear must wait for the image to be acquired, which is signalled at the colour attachment stage
+	VkSubpassDependency dependency = {};
+	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependency.dstSubpass = 0;
+	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency.srcAccessMask = 0;
+	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+	VkRenderPassCreateInfo renderPassCreateInfo = {};
+	renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassCreateInfo.attachmentCount = 1;
+	renderPassCreateInfo.pAttachments = &colourAttachment;
+	renderPassCreateInfo.subpassCount = 1;
+	renderPassCreateInfo.pSubpasses = &subpass;
+	renderPassCreateInfo.dependencyCount = 1;
+	renderPassCreateInfo.pDependencies = &dependency;
+
+	VkRenderPass renderPass;
+	VkResult result = vkCreateRenderPass(context->getLogicalDevice(), &renderPassCreateInfo, nullptr, &renderPass);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Render Pass!");
+	}
+
+	return context->getLifetimes().Make(renderPass, "VkRenderPass", vkDestroyRenderPass);
+}
+
+void PresentationSurface::CreateSynchronisation()
+{
+	// Each frame in flight acquires its own image, so needs its own semaphore to know when it's ready
+	VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+	semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	for (size_t i = 0; i < MAX_FRAME_DRAWS; i++) {
+		VkSemaphore semaphore;
+		if (vkCreateSemaphore(context->getLogicalDevice(), &semaphoreCreateInfo, nullptr, &semaphore) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create a Semaphore!");
+		}
+
+		imageAvailable.push_back(context->getLifetimes().Make(semaphore, "VkSemaphore", vkDestroySemaphore));
+	}
+}
+
+// Best format is subjective, but ours will be:
+// Format		:	VK_FORMAT_R8G8B8A8_UNORM			(VK_FORMAT_B8G8R8A8_UNORM backup value)
+// ColourSpace	:	VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
+VkSurfaceFormatKHR PresentationSurface::chooseBestSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& formats)
+{
+	// If only 1 format available and is undefined, then this means ALL formats are available (no restrictions)
+	if (formats.size() == 1 && formats[0].format == VK_FORMAT_UNDEFINED) {
+		return { VK_FORMAT_R8G8B8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+	}
+
+	// If restricted, search for optimal format
+	for (const auto &format : formats) {
+		if ((format.format == VK_FORMAT_R8G8B8A8_UNORM || format.format == VK_FORMAT_B8G8R8A8_UNORM) && format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
+			return format;
+		}
+	}
+
+	return formats[0];
+}
+
+VkExtent2D PresentationSurface::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& surfaceCapabilities)
+{
+	// If current extent is at numeric limits, then extent can vary. Otherwise, it is the size of the window.
+	if (surfaceCapabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
+		return surfaceCapabilities.currentExtent;
+	}
+	else {
+
+		// If value can vary, need to set manually
+
+		// Get window size
+		int width, height;
+		glfwGetFramebufferSize(window, &width, &height);
+
+		// Create new extent using window size
+		VkExtent2D newExtent = {};
+		newExtent.width = static_cast<uint32_t>(width);
+		newExtent.height = static_cast<uint32_t>(height);
+
+		// Surface also defines max and min, so make sure within boundaries by clamping value
+		newExtent.width = std::max(surfaceCapabilities.minImageExtent.width, std::min(surfaceCapabilities.maxImageExtent.width, newExtent.width));
+		newExtent.height = std::max(surfaceCapabilities.minImageExtent.height, std::min(surfaceCapabilities.maxImageExtent.height, newExtent.height));
+	
+		return newExtent;
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <chrono>
+
+#include "Utilities.h"
+#include "VulkanContext.h"
+#include "PresentPolicy.h"
+#include "FramePacing.h"
+
+// Presentation state for one window: surface, swapchain, and the semaphores used to acquire its images.
+// All surfaces share the device in VulkanContext and are presented together in one vkQueuePresentKHR.
+class PresentationSurface
+{
+public:
+	PresentationSurface();
+	~PresentationSurface();
+
+	void init(VulkanContext* newContext, GLFWwindow* newWindow, VkSurfaceKHR newSurface, const PresentPolicy& presentPolicy);
+	void CleanUp();
+
+	// - Swapchain Functions
+	void RecreateSwapChain(const PresentPolicy& presentPolicy);
+	VkResult AcquireNextImage(int frame);
+
+	// - Pacing Functions
+	uint64_t NextPresentId(std::chrono::steady_clock::time_point inputSampleTime);
+	void WaitForPendingPresents(uint32_t maxQueuedPresents);
+	void MeasurePresentLatency(FramePacingStats& stats);
+	VkResult getPresentWaitResult() const { return presentWaitResult; }
+
+	// - Get Functions
+	GLFWwindow* getWindow() const { return window; }
+	VkSwapchainKHR getSwapChain() const { return swapChain; }
+	VkSemaphore getImageAvailable(int frame) const { return imageAvailable[frame]; }
+	uint32_t getImageIndex() const { return imageIndex; }
+	VkImage getCurrentImage() const { return swapChainImages[imageIndex].image; }
+	VkFramebuffer getCurrentFramebuffer() const { return swapChainImages[imageIndex].framebuffer; }
+	VkRenderPass getClearRenderPass() const { return clearRenderPass; }
+	bool isClearedWithRenderPass() const { return clearRenderPass.get() != VK_NULL_HANDLE; }
+	size_t getImageCount() const { return swapChainImages.size(); }
+	VkExtent2D getExtent() const { return swapChainExtent; }
+	VkFormat getImageFormat() const { return swapChainImageFormat; }
+	const PresentPolicySettings& getPresentSettings() const { return presentSettings; }
+
+private:
+	VulkanContext* context = nullptr;
+	GLFWwindow* window = nullptr;
+
+	// Vulkan Components
+	VkSurfaceKHR surface = VK_NULL_HANDLE;
+	UniqueHandle<VkSwapchainKHR> swapChain;
+	std::vector<SwapchainImage> swapChainImages;
+	std::vector<UniqueHandle<VkSemaphore>> imageAvailable;		// One per frame in flight
+	UniqueHandle<VkRenderPass> clearRenderPass;					// Only when the surface can't be a transfer destination
+	uint32_t imageIndex = 0;									// Image acquired for the current frame
+
+	// - Utility
+	VkFormat swapChainImageFormat;
+	VkExtent2D swapChainExtent;
+	PresentPolicySettings presentSettings;
+
+	// - Present Pacing
+	uint64_t presentId = 0;										// Id of the last present on the current swapchain
+	uint64_t lastMeasuredPresentId = 0;							// Last present whose latency has been recorded
+	VkResult presentWaitResult = VK_SUCCESS;					// Error from the last present wait, handled by draw()
+	std::chrono::steady_clock::time_point presentInputTimes[PRESENT_HISTORY_SIZE];
+
+	// Vulkan Functions
+	// - Create Functions
+	void CreateSwapChain(const PresentPolicy& presentPolicy);
+	void CreateSynchronisation();
+	UniqueHandle<VkRenderPass> CreateClearRenderPass(VkFormat format);
+
+	// - Support Functions
+	void WaitForQueuedPresents();
+
+	// -- Choose Functions
+	VkSurfaceFormatKHR chooseBestSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& formats);
+	VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& surfaceCapabilities);
+};
@@ -0,0 +1,432 @@
+#include "QueueScheduler.h"
+
+#include <chrono>
+
+QueueScheduler::QueueScheduler()
+{
+}
+
+QueueScheduler::~QueueScheduler()
+{
+}
+
+void QueueScheduler::init(VulkanContext* newContext)
+{
+	context = newContext;
+
+	// Without timeline semaphores one queue can't wait on another's work, so everything goes to the device's main queue
+	legacySubmit = !context->isSubmit2Supported();
+
+	// A headless device may have no second queue, and the graphics device no separate compute queue,
+	// so whichever is missing shares the other's lane
+	VkQueue queues[static_cast<int>(QueueType::Count)] = { context->getGraphicsQueue(), context->getComputeQueue() };
+	if (legacySubmit) {
+		VkQueue mainQueue = context->isHeadless() ? context->getComputeQueue() : context->getGraphicsQueue();
+		queues[0] = mainQueue;
+		queues[1] = mainQueue;
+	}
+
+	for (int i = 0; i < static_cast<int>(QueueType::Count); i++) {
+		if (queues[i] == VK_NULL_HANDLE) {
+			queues[i] = queues[i == 0 ? 1 : 0];
+		}
+		if (queues[i] == VK_NULL_HANDLE) {
+			throw std::runtime_error("Queue scheduler has no queue to submit to!");
+		}
+
+		laneIndices[i] = -1;
+		for (size_t lane = 0; lane < lanes.size(); lane++) {
+			if (lanes[lane].queue == queues[i]) {
+				laneIndices[i] = static_cast<int>(lane);
+			}
+		}
+
+		if (laneIndices[i] == -1) {
+			QueueLane lane = {};
+			lane.queue = queues[i];
+			lane.timeline = VK_NULL_HANDLE;
+
+			if (legacySubmit) {
+				laneIndices[i] = static_cast<int>(lanes.size());
+				lanes.push_back(lane);
+				continue;
+			}
+
+			// Timeline starts at 0, and the first enqueued work signals 1
+			VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo = {};
+			semaphoreTypeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+			semaphoreTypeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+			semaphoreTypeCreateInfo.initialValue = 0;
+
+			VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+			semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			semaphoreCreateInfo.pNext = &semaphoreTypeCreateInfo;
+
+			if (vkCreateSemaphore(context->getLogicalDevice(), &semaphoreCreateInfo, nullptr, &lane.timeline) != VK_SUCCESS) {
+				throw std::runtime_error("Failed to create a Timeline Semaphore!");
+			}
+
+			laneIndices[i] = static_cast<int>(lanes.size());
+			lanes.push_back(lane);
+		}
+	}
+
+	context->getDeletionQueue().push([this]() {
+		for (auto& lane : lanes) {
+			if (lane.timeline != VK_NULL_HANDLE) {
+				vkDestroySemaphore(context->getLogicalDevice(), lane.timeline, nullptr);
+			}
+			for (const auto& submitFence : lane.submitFences) {
+				vkDestroyFence(context->getLogicalDevice(), submitFence.fence, nullptr);
+			}
+			for (VkFence fence : lane.freeFences) {
+				vkDestroyFence(context->getLogicalDevice(), fence, nullptr);
+			}
+		}
+		lanes.clear();
+	});
+}
+
+SubmitTicket QueueScheduler::Enqueue(QueueType queue, VkCommandBuffer commandBuffer, const std::vector<SubmitTicket>& dependencies, VkPipelineStageFlags2 waitStage)
+{
+	QueueLane& lane = getLane(queue);
+
+	PendingWork work = {};
+	work.commandBuffer = commandBuffer;
+	work.value = lane.nextValue++;
+	work.waits.swap(lane.binaryWaits);
+
+	for (const auto& dependency : dependencies) {
+		QueueLane& dependencyLane = getLane(dependency.queue);
+
+		// Same queue: submitted in order, nothing to wait on
+		if (dependency.value == 0 || &dependencyLane == &lane) {
+			continue;
+		}
+
+		// Only the latest value on each timeline matters
+		bool merged = false;
+		for (auto& wait : work.waits) {
+			if (wait.semaphore == dependencyLane.timeline) {
+				wait.value = std::max(wait.value, dependency.value);
+				wait.stageMask |= waitStage;
+				merged = true;
+			}
+		}
+
+		if (!merged) {
+			VkSemaphoreSubmitInfo wait = {};
+			wait.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+			wait.semaphore = dependencyLane.timeline;
+			wait.value = dependency.value;
+			wait.stageMask = waitStage;
+			work.waits.push_back(wait);
+		}
+
+		// Still waiting to be flushed: make sure its batch ends with it, so this queue isn't held up by whatever follows
+		if (dependency.value > dependencyLane.submittedValue && !dependencyLane.pending.empty()) {
+			size_t index = static_cast<size_t>(dependency.value - dependencyLane.pending.front().value);
+			if (index < dependencyLane.pending.size()) {
+				dependencyLane.pending[index].waitedOn = true;
+			}
+		}
+	}
+
+	lane.pending.push_back(std::move(work));
+
+	if (mode == SubmitMode::Immediate) {
+		FlushLane(lane);
+	}
+
+	SubmitTicket ticket;
+	ticket.queue = queue;
+	ticket.value = lane.pending.empty() ? lane.submittedValue : lane.pending.back().value;
+	return ticket;
+}
+
+void QueueScheduler::WaitSemaphore(QueueType queue, VkSemaphore semaphore, VkPipelineStageFlags2 waitStage)
+{
+	VkSemaphoreSubmitInfo wait = {};
+	wait.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	wait.semaphore = semaphore;
+	wait.value = 0;													// Ignored for binary semaphores
+	wait.stageMask = waitStage;
+
+	getLane(queue).binaryWaits.push_back(wait);
+}
+
+void QueueScheduler::SignalSemaphore(QueueType queue, VkSemaphore semaphore)
+{
+	getLane(queue).binarySignals.push_back(semaphore);
+}
+
+void QueueScheduler::Flush()
+{
+	// Every queue's timeline can be waited on before it is signalled, so the order lanes are flushed in doesn't matter
+	for (auto& lane : lanes) {
+		FlushLane(lane);
+	}
+}
+
+bool QueueScheduler::Wait(const SubmitTicket& ticket, uint64_t timeout)
+{
+	if (ticket.value == 0) {
+		return true;
+	}
+
+	QueueLane& lane = getLane(ticket.queue);
+	if (ticket.value > lane.submittedValue) {
+		throw std::runtime_error("Waiting on work that hasn't been flushed!");
+	}
+
+	if (legacySubmit) {
+		// The first flush that reached the ticket's value. None left in flight means it has already been recycled, so is done
+		for (const auto& submitFence : lane.submitFences) {
+			if (submitFence.value >= ticket.value) {
+				if (vkWaitForFences(context->getLogicalDevice(), 1, &submitFence.fence, VK_TRUE, timeout) != VK_SUCCESS) {
+					return false;
+				}
+				break;
+			}
+		}
+
+		RecycleFences(lane);
+		return true;
+	}
+
+	VkSemaphoreWaitInfo waitInfo = {};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &lane.timeline;
+	waitInfo.pValues = &ticket.value;
+
+	return vkWaitSemaphores(context->getLogicalDevice(), &waitInfo, timeout) == VK_SUCCESS;
+}
+
+bool QueueScheduler::isComplete(const SubmitTicket& ticket) const
+{
+	if (ticket.value == 0) {
+		return true;
+	}
+
+	const QueueLane& lane = getLane(ticket.queue);
+	if (legacySubmit) {
+		if (ticket.value > lane.submittedValue) {
+			return false;
+		}
+
+		for (const auto& submitFence : lane.submitFences) {
+			if (submitFence.value >= ticket.value) {
+				return vkGetFenceStatus(context->getLogicalDevice(), submitFence.fence) == VK_SUCCESS;
+			}
+		}
+		return true;
+	}
+
+	uint64_t completedValue = 0;
+	vkGetSemaphoreCounterValue(context->getLogicalDevice(), lane.timeline, &completedValue);
+	return completedValue >= ticket.value;
+}
+
+SubmitTicket QueueScheduler::getLastTicket(QueueType queue) const
+{
+	// Everything enqueued so far on the queue, flushed or not
+	SubmitTicket ticket;
+	ticket.queue = queue;
+	ticket.value = getLane(queue).nextValue - 1;
+	return ticket;
+}
+
+void QueueScheduler::FlushLane(QueueLane& lane)
+{
+	if (lane.pending.empty() && lane.binarySignals.empty()) {
+		return;
+	}
+
+	if (legacySubmit) {
+		FlushLegacyLane(lane);
+		return;
+	}
+
+	// -- SPLIT INTO BATCHES --
+	// A batch's waits hold up all of it and its signal waits for all of it, so a new batch starts at
+	// every command buffer with waits, and after every command buffer another queue is waiting on
+	std::vector<size_t> batchStarts;
+	for (size_t i = 0; i < lane.pending.size(); i++) {
+		if (i == 0 || !lane.pending[i].waits.empty() || lane.pending[i - 1].waitedOn) {
+			batchStarts.push_back(i);
+		}
+	}
+
+	// Sized up front, VkSubmitInfo2 points into these
+	std::vector<VkCommandBufferSubmitInfo> commandBufferInfos(lane.pending.size());
+	std::vector<VkSemaphoreSubmitInfo> signalInfos(batchStarts.size() + lane.binarySignals.size());
+	std::vector<VkSubmitInfo2> submitInfos(std::max<size_t>(batchStarts.size(), 1));
+
+	for (size_t i = 0; i < lane.pending.size(); i++) {
+		commandBufferInfos[i].sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+		commandBufferInfos[i].commandBuffer = lane.pending[i].commandBuffer;
+	}
+
+	for (size_t batch = 0; batch < submitInfos.size(); batch++) {
+		VkSubmitInfo2& submitInfo = submitInfos[batch];
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+
+		// A flush with only binary signals is an empty batch, which still signals after all earlier work on the queue
+		if (lane.pending.empty()) {
+			continue;
+		}
+
+		size_t first = batchStarts[batch];
+		size_t end = batch + 1 < batchStarts.size() ? batchStarts[batch + 1] : lane.pending.size();
+		const PendingWork& firstWork = lane.pending[first];
+
+		submitInfo.waitSemaphoreInfoCount = static_cast<uint32_t>(firstWork.waits.size());		// Only the first command buffer of a batch has waits
+		submitInfo.pWaitSemaphoreInfos = firstWork.waits.data();
+		submitInfo.commandBufferInfoCount = static_cast<uint32_t>(end - first);
+		submitInfo.pCommandBufferInfos = &commandBufferInfos[first];
+
+		// Signal the timeline up to the last command buffer in the batch
+		VkSemaphoreSubmitInfo& timelineSignal = signalInfos[batch];
+		timelineSignal.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+		timelineSignal.semaphore = lane.timeline;
+		timelineSignal.value = lane.pending[end - 1].value;
+		timelineSignal.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+		submitInfo.signalSemaphoreInfoCount = 1;
+		submitInfo.pSignalSemaphoreInfos = &timelineSignal;
+
+		stats.commandBuffers += end - first;
+		stats.semaphoreWaits += firstWork.waits.size();
+	}
+
+	// Binary signals go on the last batch, after the timeline signal
+	if (!lane.binarySignals.empty()) {
+		size_t firstBinary = batchStarts.size();
+		for (size_t i = 0; i < lane.binarySignals.size(); i++) {
+			VkSemaphoreSubmitInfo& binarySignal = signalInfos[firstBinary + i];
+			binarySignal.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+			binarySignal.semaphore = lane.binarySignals[i];
+			binarySignal.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		}
+
+		VkSubmitInfo2& lastSubmit = submitInfos.back();
+		size_t firstSignal = lane.pending.empty() ? firstBinary : firstBinary - 1;
+		lastSubmit.signalSemaphoreInfoCount = static_cast<uint32_t>(signalInfos.size() - firstSignal);
+		lastSubmit.pSignalSemaphoreInfos = &signalInfos[firstSignal];
+	}
+
+	// -- SUBMIT --
+	auto submitStart = std::chrono::steady_clock::now();
+	VkResult result = context->getQueueSubmit2Function()(lane.queue, static_cast<uint32_t>(submitInfos.size()), submitInfos.data(), VK_NULL_HANDLE);
+	stats.submitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - submitStart).count();
+
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to submit command buffers to queue!");
+	}
+
+	stats.submitCalls++;
+	stats.batches += submitInfos.size();
+
+	if (!lane.pending.empty()) {
+		lane.submittedValue = lane.pending.back().value;
+	}
+	lane.pending.clear();
+	lane.binarySignals.clear();
+}
+
+void QueueScheduler::FlushLegacyLane(QueueLane& lane)
+{
+	// -- GATHER --
+	// Every QueueType shares this lane, so the only waits are binary (swapchain) ones, and one VkSubmitInfo takes
+	// the whole flush. Its waits hold up all of it, which costs some overlap but nothing else could run on the queue anyway
+	std::vector<VkCommandBuffer> commandBuffers;
+	std::vector<VkSemaphore> waitSemaphores;
+	std::vector<VkPipelineStageFlags> waitStages;
+	for (const auto& work : lane.pending) {
+		commandBuffers.push_back(work.commandBuffer);
+
+		for (const auto& wait : work.waits) {
+			waitSemaphores.push_back(wait.semaphore);
+			waitStages.push_back(static_cast<VkPipelineStageFlags>(wait.stageMask));		// The legacy stage bits have the same values
+		}
+	}
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+	submitInfo.pWaitSemaphores = waitSemaphores.data();
+	submitInfo.pWaitDstStageMask = waitStages.data();
+	submitInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+	submitInfo.pCommandBuffers = commandBuffers.data();
+	submitInfo.signalSemaphoreCount = static_cast<uint32_t>(lane.binarySignals.size());
+	submitInfo.pSignalSemaphores = lane.binarySignals.data();
+
+	// A flush with only binary signals has nothing new to wait for
+	VkFence fence = lane.pending.empty() ? VK_NULL_HANDLE : AcquireFence(lane);
+
+	// -- SUBMIT --
+	auto submitStart = std::chrono::steady_clock::now();
+	VkResult result = vkQueueSubmit(lane.queue, 1, &submitInfo, fence);
+	stats.submitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - submitStart).count();
+
+	if (result != VK_SUCCESS) {
+		if (fence != VK_NULL_HANDLE) {
+			lane.freeFences.push_back(fence);
+		}
+		throw std::runtime_error("Failed to submit command buffers to queue!");
+	}
+
+	stats.submitCalls++;
+	stats.batches++;
+	stats.commandBuffers += commandBuffers.size();
+	stats.semaphoreWaits += waitSemaphores.size();
+
+	if (!lane.pending.empty()) {
+		lane.submittedValue = lane.pending.back().value;
+
+		SubmitFence submitFence;
+		submitFence.fence = fence;
+		submitFence.value = lane.submittedValue;
+		lane.submitFences.push_back(submitFence);
+	}
+	lane.pending.clear();
+	lane.binarySignals.clear();
+}
+
+VkFence QueueScheduler::AcquireFence(QueueLane& lane)
+{
+	RecycleFences(lane);
+
+	if (!lane.freeFences.empty()) {
+		VkFence fence = lane.freeFences.back();
+		lane.freeFences.pop_back();
+		return fence;
+	}
+
+	// Created unsignalled, so it can go straight to vkQueueSubmit
+	VkFenceCreateInfo fenceCreateInfo = {};
+	fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	VkFence fence;
+	if (vkCreateFence(context->getLogicalDevice(), &fenceCreateInfo, nullptr, &fence) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Fence!");
+	}
+
+	return fence;
+}
+
+void QueueScheduler::RecycleFences(QueueLane& lane)
+{
+	// Oldest first, stopping at the first flush still in flight so the list stays in submission order
+	while (!lane.submitFences.empty()) {
+		VkFence fence = lane.submitFences.front().fence;
+		if (vkGetFenceStatus(context->getLogicalDevice(), fence) != VK_SUCCESS) {
+			break;
+		}
+
+		vkResetFences(context->getLogicalDevice(), 1, &fence);
+		lane.freeFences.push_back(fence);
+		lane.submitFences.pop_front();
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdexcept>
+#include <vector>
+#include <deque>
+#include <limits>
+
+#include "VulkanContext.h"
+
+// Queues work can be sent to. A type the device has no queue for shares the other type's queue,
+// and without timeline semaphores every type shares one queue.
+enum class QueueType {
+	Graphics,
+	Compute,
+	Count
+};
+
+// How Enqueue hands work to Vulkan
+enum class SubmitMode {
+	Immediate,										// One submit call per Enqueue, as if every producer submitted on its own
+	Batched											// Held until Flush, then one submit call per queue
+};
+
+// A point on a queue's timeline: the work is finished once the timeline reaches value
+struct SubmitTicket {
+	QueueType queue = QueueType::Graphics;
+	uint64_t value = 0;								// 0 is always complete
+};
+
+struct SubmitStats {
+	uint64_t submitCalls = 0;						// vkQueueSubmit2 (or vkQueueSubmit) calls
+	uint64_t batches = 0;							// VkSubmitInfo2 (or VkSubmitInfo) across all those calls
+	uint64_t commandBuffers = 0;
+	uint64_t semaphoreWaits = 0;					// Cross-queue timeline waits and binary (swapchain) waits
+	double submitSeconds = 0.0;						// CPU time spent inside the submit calls
+
+	double getMicrosecondsPerSubmit() const { return submitCalls > 0 ? submitSeconds * 1.0e6 / submitCalls : 0.0; }
+};
+
+// Collects command buffers from any number of producers over a frame and submits them together.
+// Every queue has a timeline semaphore, and every enqueued command buffer gets the next value on it,
+// so dependencies are just (queue, value) pairs:
+// - On the same queue, submission order is enough. As within one command buffer, the consumer still needs its own barriers.
+// - Across queues, the consumer's batch waits on the producer's timeline value.
+// Flush sends each queue's work in one vkQueueSubmit2, only splitting it into more VkSubmitInfo2
+// where a cross-queue wait or signal would otherwise hold up unrelated work.
+// Without timeline semaphores and synchronization2 there are no cross-queue waits to express, so every
+// QueueType goes to one queue, each flush is a single vkQueueSubmit, and the timeline is tracked with a fence per flush.
+class QueueScheduler
+{
+public:
+	QueueScheduler();
+	~QueueScheduler();
+
+	void init(VulkanContext* newContext);
+
+	void setMode(SubmitMode newMode) { mode = newMode; }
+	SubmitMode getMode() const { return mode; }
+
+	// - Producers
+	SubmitTicket Enqueue(QueueType queue, VkCommandBuffer commandBuffer, const std::vector<SubmitTicket>& dependencies = {},
+		VkPipelineStageFlags2 waitStage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+
+	// Binary semaphores for the swapchain, which can't use timelines:
+	// a wait holds up the next command buffer enqueued on the queue, a signal fires once everything flushed with it is done
+	void WaitSemaphore(QueueType queue, VkSemaphore semaphore, VkPipelineStageFlags2 waitStage);
+	void SignalSemaphore(QueueType queue, VkSemaphore semaphore);
+
+	void Flush();
+
+	// - Completion
+	// Returns false on timeout. The ticket must have been flushed, or it would never complete
+	bool Wait(const SubmitTicket& ticket, uint64_t timeout = std::numeric_limits<uint64_t>::max());
+	bool isComplete(const SubmitTicket& ticket) const;
+	SubmitTicket getLastTicket(QueueType queue) const;
+
+	// - Metrics
+	const SubmitStats& getStats() const { return stats; }
+	void ResetStats() { stats = SubmitStats(); }
+	size_t getLaneCount() const { return lanes.size(); }
+	bool isLegacySubmit() const { return legacySubmit; }
+
+private:
+	struct PendingWork {
+		VkCommandBuffer commandBuffer;
+		uint64_t value;										// Timeline value signalled when this is done
+		std::vector<VkSemaphoreSubmitInfo> waits;			// Must all be satisfied before this starts
+		bool waitedOn = false;								// Another queue waits for this value, so end the batch here
+	};
+
+	// Legacy path only: signalled once everything up to value is done
+	struct SubmitFence {
+		VkFence fence;
+		uint64_t value;
+	};
+
+	// One per distinct VkQueue
+	struct QueueLane {
+		VkQueue queue;
+		VkSemaphore timeline;								// VK_NULL_HANDLE on the legacy path
+		uint64_t nextValue = 1;								// Given to the next enqueued command buffer
+		uint64_t submittedValue = 0;						// Highest value sent to the queue
+		std::vector<PendingWork> pending;
+		std::vector<VkSemaphoreSubmitInfo> binaryWaits;		// Taken by the next Enqueue
+		std::vector<VkSemaphore> binarySignals;				// Signalled by the last batch of the next flush
+		std::deque<SubmitFence> submitFences;				// Legacy path: one per flush still in flight, oldest first
+		std::vector<VkFence> freeFences;					// Legacy path: signalled and reset, ready for the next flush
+	};
+
+	VulkanContext* context = nullptr;
+	SubmitMode mode = SubmitMode::Batched;
+	bool legacySubmit = false;								// No timeline semaphores or vkQueueSubmit2 on the device
+
+	std::vector<QueueLane> lanes;
+	int laneIndices[static_cast<int>(QueueType::Count)];	// Lane each QueueType submits to
+
+	SubmitStats stats;
+
+	// - Support Functions
+	QueueLane& getLane(QueueType queue) { return lanes[laneIndices[static_cast<int>(queue)]]; }
+	const QueueLane& getLane(QueueType queue) const { return lanes[laneIndices[static_cast<int>(queue)]]; }
+	void FlushLane(QueueLane& lane);
+	void FlushLegacyLane(QueueLane& lane);
+	VkFence AcquireFence(QueueLane& lane);
+	void RecycleFences(QueueLane& lane);
+};
@@ -0,0 +1,12 @@
+@echo off
+rem Builds the .spv files the compute jobs load. Optional argument: output directory (e.g. the executable's Shaders folder)
+set OUT=%~f1
+cd /d "%~dp0"
+if "%OUT%"=="" set OUT=.
+if not exist "%OUT%" mkdir "%OUT%"
+
+%VULKAN_SDK%\Bin\glslangValidator.exe -V colour_convert.comp -o "%OUT%\colour_convert.spv"
+%VULKAN_SDK%\Bin\glslangValidator.exe -V resize.comp -o "%OUT%\resize.spv"
+%VULKAN_SDK%\Bin\glslangValidator.exe -V histogram.comp -o "%OUT%\histogram.spv"
+
+if "%~1"=="" pause
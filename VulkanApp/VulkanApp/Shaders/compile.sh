@@ -0,0 +1,17 @@
+#!/bin/sh
+# Builds the .spv files the compute jobs load. Optional argument: output directory (e.g. the executable's Shaders folder)
+set -e
+OUT="${1:-$(dirname "$0")}"
+mkdir -p "$OUT"
+OUT="$(cd "$OUT" && pwd)"
+cd "$(dirname "$0")"
+
+# Prefer the SDK's compiler, otherwise whatever is on PATH
+GLSLANG=glslangValidator
+if [ -n "$VULKAN_SDK" ] && [ -x "$VULKAN_SDK/bin/glslangValidator" ]; then
+	GLSLANG="$VULKAN_SDK/bin/glslangValidator"
+fi
+
+"$GLSLANG" -V colour_convert.comp -o "$OUT/colour_convert.spv"
+"$GLSLANG" -V resize.comp -o "$OUT/resize.spv"
+"$GLSLANG" -V histogram.comp -o "$OUT/histogram.spv"
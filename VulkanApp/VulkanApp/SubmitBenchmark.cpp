@@ -0,0 +1,177 @@
+#include "SubmitBenchmark.h"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+
+#include "VulkanContext.h"
+#include "QueueScheduler.h"
+
+// Frames run before timing each mode, so first-submit costs in the driver aren't counted
+static const int SUBMIT_BENCHMARK_WARMUP_FRAMES = 30;
+static const VkDeviceSize PRODUCER_REGION_SIZE = 256;		// Bytes each producer clears per frame
+
+struct SubmitBenchmarkResult {
+	SubmitStats stats;
+	double enqueueSeconds;									// CPU time from the first Enqueue to the end of Flush, all frames
+	double seconds;
+};
+
+static SubmitBenchmarkResult runSubmitMode(QueueScheduler& scheduler, SubmitMode mode, const std::vector<VkCommandBuffer>& commandBuffers, int frameCount, int producers)
+{
+	using Clock = std::chrono::steady_clock;
+
+	SubmitBenchmarkResult result = {};
+	scheduler.setMode(mode);
+
+	// Last ticket on each queue type, per frame in flight
+	std::vector<SubmitTicket> frameTickets(MAX_FRAME_DRAWS * static_cast<int>(QueueType::Count));
+
+	Clock::time_point start = Clock::now();
+	for (int frame = -SUBMIT_BENCHMARK_WARMUP_FRAMES; frame < frameCount; frame++) {
+		if (frame == 0) {
+			scheduler.ResetStats();
+			result.enqueueSeconds = 0.0;
+			start = Clock::now();
+		}
+
+		int slot = (frame + SUBMIT_BENCHMARK_WARMUP_FRAMES) % MAX_FRAME_DRAWS;
+
+		// -- WAIT FOR FRAME --
+		for (int queue = 0; queue < static_cast<int>(QueueType::Count); queue++) {
+			scheduler.Wait(frameTickets[slot * static_cast<int>(QueueType::Count) + queue]);
+		}
+
+		// -- PRODUCERS --
+		// Alternate queues so a device with a separate compute queue gets cross-queue edges
+		Clock::time_point enqueueStart = Clock::now();
+
+		SubmitTicket previous;
+		for (int producer = 0; producer < producers; producer++) {
+			QueueType queue = producer % 2 == 0 ? QueueType::Graphics : QueueType::Compute;
+			previous = scheduler.Enqueue(queue, commandBuffers[slot * producers + producer], { previous }, VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+		}
+
+		scheduler.Flush();
+		result.enqueueSeconds += std::chrono::duration<double>(Clock::now() - enqueueStart).count();
+
+		for (int queue = 0; queue < static_cast<int>(QueueType::Count); queue++) {
+			frameTickets[slot * static_cast<int>(QueueType::Count) + queue] = scheduler.getLastTicket(static_cast<QueueType>(queue));
+		}
+	}
+
+	for (const auto& ticket : frameTickets) {
+		scheduler.Wait(ticket);
+	}
+
+	result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	result.stats = scheduler.getStats();
+	return result;
+}
+
+static void printSubmitResult(const char* label, const SubmitBenchmarkResult& result, int frameCount)
+{
+	printf("  %-8s %13.2f %13.2f %11.2f %15.2f %11.1f\n", label,
+		static_cast<double>(result.stats.submitCalls) / frameCount,
+		static_cast<double>(result.stats.batches) / frameCount,
+		result.stats.getMicrosecondsPerSubmit(),
+		result.enqueueSeconds * 1.0e6 / frameCount,
+		frameCount / result.seconds);
+}
+
+int runSubmitBenchmark(int frameCount, int producers, const char* preferredDeviceName)
+{
+	VulkanContext context;
+	QueueScheduler scheduler;
+	SubmitBenchmarkResult naive = {};
+	SubmitBenchmarkResult batched = {};
+
+	try {
+		context.CreateInstance(true);
+		context.CreateComputeDevice(preferredDeviceName);
+		scheduler.init(&context);
+
+		VkPhysicalDevice physicalDevice = context.getPhysicalDevice();
+		VkDevice device = context.getLogicalDevice();
+
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+		printf("Submit benchmark on %s: %d producers, %d frames, %zu queue(s)\n",
+			deviceProperties.deviceName, producers, frameCount, scheduler.getLaneCount());
+
+		// Which case ran: with one queue the dependency chain is just submission order, nothing waits across queues
+		bool crossQueue = scheduler.getLaneCount() > 1;
+		printf("  dependencies: %s\n", crossQueue ? "cross-queue timeline waits between two queues" : "same queue only (device has one usable queue)");
+		printf("  submit path: %s\n", scheduler.isLegacySubmit() ?
+			"vkQueueSubmit with a fence per flush (no timeline semaphores or synchronization2)" : "vkQueueSubmit2 with timeline semaphores");
+
+		// Each producer clears its own region, so the only ordering between them is the dependency chain
+		VkBuffer buffer;
+		VkDeviceMemory bufferMemory;
+		createBuffer(physicalDevice, device, PRODUCER_REGION_SIZE * producers, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &buffer, &bufferMemory);
+
+		context.getDeletionQueue().push([device, buffer, bufferMemory]() {
+			vkDestroyBuffer(device, buffer, nullptr);
+			vkFreeMemory(device, bufferMemory, nullptr);
+		});
+
+		// One command buffer per producer per frame in flight, recorded once so only submission is measured
+		std::vector<VkCommandBuffer> commandBuffers(MAX_FRAME_DRAWS * producers);
+
+		VkCommandBufferAllocateInfo cbAllocInfo = {};
+		cbAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		cbAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		cbAllocInfo.commandBufferCount = 1;
+
+		for (size_t i = 0; i < commandBuffers.size(); i++) {
+			// Graphics producers run on the second queue when there is one, which may be in another family with its own pool
+			bool graphicsProducer = (i % producers) % 2 == 0;
+			cbAllocInfo.commandPool = crossQueue && graphicsProducer ? context.getGraphicsCommandPool() : context.getComputeCommandPool();
+
+			if (vkAllocateCommandBuffers(device, &cbAllocInfo, &commandBuffers[i]) != VK_SUCCESS) {
+				throw std::runtime_error("Failed to allocate Command Buffers!");
+			}
+		}
+
+		VkCommandBufferBeginInfo bufferBeginInfo = {};
+		bufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+		for (size_t i = 0; i < commandBuffers.size(); i++) {
+			if (vkBeginCommandBuffer(commandBuffers[i], &bufferBeginInfo) != VK_SUCCESS) {
+				throw std::runtime_error("Failed to start recording a Command Buffer!");
+			}
+
+			VkDeviceSize offset = (i % producers) * PRODUCER_REGION_SIZE;
+			vkCmdFillBuffer(commandBuffers[i], buffer, offset, PRODUCER_REGION_SIZE, static_cast<uint32_t>(i));
+
+			if (vkEndCommandBuffer(commandBuffers[i]) != VK_SUCCESS) {
+				throw std::runtime_error("Failed to stop recording a Command Buffer!");
+			}
+		}
+
+		naive = runSubmitMode(scheduler, SubmitMode::Immediate, commandBuffers, frameCount, producers);
+		batched = runSubmitMode(scheduler, SubmitMode::Batched, commandBuffers, frameCount, producers);
+	}
+	catch (const std::runtime_error& e) {
+		printf("ERROR: %s\n", e.what());
+		context.CleanUp();
+		return EXIT_FAILURE;
+	}
+
+	context.CleanUp();
+
+	printf("  %-8s %13s %13s %11s %15s %11s\n", "mode", "submits/frame", "batches/frame", "us/submit", "submit us/frame", "frames/sec");
+	printSubmitResult("naive", naive, frameCount);
+	printSubmitResult("batched", batched, frameCount);
+
+	if (naive.enqueueSeconds > 0.0) {
+		printf("  batched submission costs %.1f%% of naive CPU time per frame\n", batched.enqueueSeconds * 100.0 / naive.enqueueSeconds);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+// Simulates producers independent subsystems each submitting one small command buffer per frame, with
+// every producer depending on the one before it. Runs the same frames with every producer submitting on
+// its own (SubmitMode::Immediate) and through one QueueScheduler flush per frame (SubmitMode::Batched),
+// and compares submit calls and CPU cost. Headless, so runs on any device including lavapipe.
+// Uses a second queue when the device has one, and prints whether cross-queue waits and vkQueueSubmit2 were used.
+// Returns EXIT_SUCCESS or EXIT_FAILURE.
+int runSubmitBenchmark(int frameCount, int producers, const char* preferredDeviceName);
@@ -0,0 +1,180 @@
+#include "TraceFile.h"
+
+#include <cstring>
+
+TraceWriter::TraceWriter()
+{
+}
+
+TraceWriter::~TraceWriter()
+{
+	Close();
+}
+
+bool TraceWriter::Open(const std::string& path, const TraceHeader& header)
+{
+	Close();
+
+	file.open(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	bytesWritten = sizeof(header);
+
+	// Allocate every chunk up front, nothing is allocated while capturing
+	currentChunk.reserve(TRACE_CHUNK_SIZE);
+	for (int i = 1; i < TRACE_CHUNK_COUNT; i++) {
+		freeChunks.emplace_back();
+		freeChunks.back().reserve(TRACE_CHUNK_SIZE);
+	}
+
+	closing = false;
+	writerThread = std::thread(&TraceWriter::WriterLoop, this);
+
+	return true;
+}
+
+void TraceWriter::Write(TraceOp op, const void* payload, uint16_t size, const void* extra, uint16_t extraSize)
+{
+	if (!file.is_open()) {
+		return;
+	}
+
+	TraceRecordHeader recordHeader = {};
+	recordHeader.op = static_cast<uint8_t>(op);
+	recordHeader.size = static_cast<uint16_t>(size + extraSize);
+
+	size_t recordSize = sizeof(recordHeader) + size + extraSize;
+	if (currentChunk.size() + recordSize > TRACE_CHUNK_SIZE) {
+		SubmitChunk();
+	}
+
+	const uint8_t* headerBytes = reinterpret_cast<const uint8_t*>(&recordHeader);
+	currentChunk.insert(currentChunk.end(), headerBytes, headerBytes + sizeof(recordHeader));
+
+	if (size > 0) {
+		const uint8_t* payloadBytes = static_cast<const uint8_t*>(payload);
+		currentChunk.insert(currentChunk.end(), payloadBytes, payloadBytes + size);
+	}
+
+	if (extraSize > 0) {
+		const uint8_t* extraBytes = static_cast<const uint8_t*>(extra);
+		currentChunk.insert(currentChunk.end(), extraBytes, extraBytes + extraSize);
+	}
+
+	bytesWritten += recordSize;
+}
+
+void TraceWriter::Close()
+{
+	if (!file.is_open()) {
+		return;
+	}
+
+	Write(TraceOp::EndTrace, nullptr, 0);
+
+	// Hand over what's left and let the writer drain everything before stopping it
+	{
+		std::lock_guard<std::mutex> lock(chunkMutex);
+		if (!currentChunk.empty()) {
+			fullChunks.push_back(std::move(currentChunk));
+		}
+		closing = true;
+	}
+	chunkReady.notify_one();
+	writerThread.join();
+
+	file.close();
+
+	currentChunk = std::vector<uint8_t>();
+	fullChunks.clear();
+	freeChunks.clear();
+}
+
+void TraceWriter::SubmitChunk()
+{
+	std::unique_lock<std::mutex> lock(chunkMutex);
+	fullChunks.push_back(std::move(currentChunk));
+	chunkReady.notify_one();
+
+	// Only blocks if the disk can't keep up with every chunk in the pool
+	chunkFree.wait(lock, [this]() { return !freeChunks.empty(); });
+	currentChunk = std::move(freeChunks.back());
+	freeChunks.pop_back();
+}
+
+void TraceWriter::WriterLoop()
+{
+	std::unique_lock<std::mutex> lock(chunkMutex);
+	while (true) {
+		chunkReady.wait(lock, [this]() { return !fullChunks.empty() || closing; });
+		if (fullChunks.empty()) {
+			return;
+		}
+
+		std::vector<uint8_t> chunk = std::move(fullChunks.front());
+		fullChunks.pop_front();
+
+		// Write without holding the lock, so the capturing thread can keep filling
+		lock.unlock();
+		file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+		chunk.clear();
+		lock.lock();
+
+		freeChunks.push_back(std::move(chunk));
+		chunkFree.notify_one();
+	}
+}
+
+bool TraceReader::Open(const std::string& path)
+{
+	// Start at the end to get the size, same as readFile
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	size_t fileSize = static_cast<size_t>(file.tellg());
+	if (fileSize < sizeof(TraceHeader)) {
+		return false;
+	}
+
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	data.resize(fileSize - sizeof(TraceHeader));
+	file.read(reinterpret_cast<char*>(data.data()), data.size());
+
+	cursor = 0;
+	return !file.fail() && header.magic == TRACE_MAGIC && header.version == TRACE_VERSION;
+}
+
+void TraceReader::Rewind()
+{
+	cursor = 0;
+}
+
+bool TraceReader::Next(TraceOp& op, const uint8_t*& payload, uint16_t& size)
+{
+	if (cursor + sizeof(TraceRecordHeader) > data.size()) {
+		return false;
+	}
+
+	TraceRecordHeader recordHeader;
+	memcpy(&recordHeader, data.data() + cursor, sizeof(recordHeader));
+	cursor += sizeof(recordHeader);
+
+	// A truncated trace (e.g. the app crashed mid-capture) ends at the last complete record
+	if (cursor + recordHeader.size > data.size()) {
+		return false;
+	}
+
+	op = static_cast<TraceOp>(recordHeader.op);
+	payload = data.data() + cursor;
+	size = recordHeader.size;
+	cursor += recordHeader.size;
+
+	return op != TraceOp::EndTrace;
+}
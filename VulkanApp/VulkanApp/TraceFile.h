@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Binary trace of what the renderer submitted, written by VulkanCapture and re-issued by VulkanReplay.
+// Layout: TraceHeader, then records of TraceRecordHeader + payload until EndTrace.
+// Handles are replaced by small ids, so a trace can be replayed on any device.
+
+const uint32_t TRACE_MAGIC = 0x52544B56;			// "VKTR"
+const uint32_t TRACE_VERSION = 1;
+const size_t TRACE_CHUNK_SIZE = 1024 * 1024;		// Records are batched into chunks this big before being written
+const int TRACE_CHUNK_COUNT = 4;					// Chunks that can be filling or waiting to be written at once
+
+enum class TraceOp : uint8_t {
+	CreateImage = 1,								// TraceCreateImage
+	CreateUniformBuffer,							// TraceCreateUniformBuffer
+	WriteBuffer,									// TraceWriteBuffer, followed by the bytes written
+	BeginFrame,										// TraceBeginFrame
+	CmdImageBarrier,								// TraceImageBarrier
+	CmdClearColorImage,								// TraceClearColorImage
+	CmdBindUniformBuffer,							// TraceBindUniformBuffer
+	Submit,											// No payload, ends the frame's command stream
+	Present,										// uint32_t count, followed by count image ids
+	EndTrace										// No payload
+};
+
+struct TraceHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t framesInFlight;						// Uniform writes assume this many frames in flight
+	uint32_t reserved;
+	char deviceName[256];							// Device the trace was captured on, for reference only
+};
+
+struct TraceRecordHeader {
+	uint8_t op;										// TraceOp
+	uint8_t reserved;
+	uint16_t size;									// Payload bytes following the header
+};
+
+struct TraceCreateImage {
+	uint32_t imageId;
+	uint32_t format;								// VkFormat
+	uint32_t width;
+	uint32_t height;
+};
+
+struct TraceCreateUniformBuffer {
+	uint32_t bufferId;
+	uint32_t range;									// Range of the dynamic uniform buffer descriptor bound to it
+	uint32_t offsetAlignment;						// Capture device's minUniformBufferOffsetAlignment, every dynamic offset is a multiple of it
+	uint32_t reserved;
+	uint64_t size;
+};
+
+struct TraceWriteBuffer {
+	uint32_t bufferId;
+	uint32_t size;
+	uint64_t offset;
+	uint64_t baseOffset;							// Where the whole write started, shared by every chunk of a split write
+};
+
+struct TraceBeginFrame {
+	uint64_t frameNumber;
+	uint64_t timestampNs;							// Since the capture started, so replay can reproduce the original pacing
+};
+
+struct TraceImageBarrier {
+	uint32_t imageId;
+	uint32_t oldLayout;
+	uint32_t newLayout;
+	uint32_t srcStage;
+	uint32_t dstStage;
+	uint32_t srcAccess;
+	uint32_t dstAccess;
+};
+
+struct TraceClearColorImage {
+	uint32_t imageId;
+	float colour[4];
+};
+
+struct TraceBindUniformBuffer {
+	uint32_t bufferId;
+	uint32_t dynamicOffset;
+};
+
+// Streams records to disk without blocking the caller on file IO. Records are copied into the current
+// chunk, and full chunks are handed to a writer thread. The caller only waits if every chunk is full.
+class TraceWriter
+{
+public:
+	TraceWriter();
+	~TraceWriter();
+
+	bool Open(const std::string& path, const TraceHeader& header);
+	void Write(TraceOp op, const void* payload, uint16_t size, const void* extra = nullptr, uint16_t extraSize = 0);
+	void Close();
+
+	bool isOpen() const { return file.is_open(); }
+	uint64_t getBytesWritten() const { return bytesWritten; }
+
+private:
+	std::ofstream file;
+	uint64_t bytesWritten = 0;
+
+	std::vector<uint8_t> currentChunk;				// Owned by the capturing thread
+	std::deque<std::vector<uint8_t>> fullChunks;	// Waiting for the writer thread
+	std::vector<std::vector<uint8_t>> freeChunks;	// Written and ready to be filled again
+
+	std::thread writerThread;
+	std::mutex chunkMutex;
+	std::condition_variable chunkReady;				// Signalled when a chunk is full, or when closing
+	std::condition_variable chunkFree;				// Signalled when the writer has finished with a chunk
+	bool closing = false;
+
+	void SubmitChunk();
+	void WriterLoop();
+};
+
+// Loads a whole trace into memory, so replay timing never includes disk reads
+class TraceReader
+{
+public:
+	bool Open(const std::string& path);
+	void Rewind();
+
+	// Returns false at EndTrace or the end of the data
+	bool Next(TraceOp& op, const uint8_t*& payload, uint16_t& size);
+
+	const TraceHeader& getHeader() const { return header; }
+	size_t getSize() const { return data.size(); }
+
+private:
+	TraceHeader header = {};
+	std::vector<uint8_t> data;
+	size_t cursor = 0;
+};
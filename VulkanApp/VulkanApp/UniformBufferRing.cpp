@@ -0,0 +1,183 @@
+#include "UniformBufferRing.h"
+
+UniformBufferRing::UniformBufferRing()
+{
+}
+
+UniformBufferRing::~UniformBufferRing()
+{
+}
+
+void UniformBufferRing::init(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkDeviceSize bytesPerFrame, VkDeviceSize maxAllocationSize, uint32_t framesInFlight)
+{
+	this->physicalDevice = physicalDevice;
+	this->logicalDevice = logicalDevice;
+
+	// Dynamic offsets must be multiples of minUniformBufferOffsetAlignment, and descriptor range can't exceed maxUniformBufferRange
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+	offsetAlignment = deviceProperties.limits.minUniformBufferOffsetAlignment;
+	atomSize = deviceProperties.limits.nonCoherentAtomSize;
+
+	if (maxAllocationSize > deviceProperties.limits.maxUniformBufferRange) {
+		throw std::runtime_error("Uniform ring allocation size exceeds maxUniformBufferRange!");
+	}
+
+	this->maxAllocationSize = maxAllocationSize;
+	regionSize = alignUp(bytesPerFrame, std::max(offsetAlignment, atomSize));
+
+	// Pad the end of the buffer by one descriptor range, so a descriptor window starting at the last offset stays inside the buffer
+	bufferSize = regionSize * framesInFlight + maxAllocationSize;
+
+	frameStats.assign(framesInFlight, UniformRingFrameStats());
+	currentFrame = 0;
+	regionHead = 0;
+
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = bufferSize;
+	bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	VkResult result = vkCreateBuffer(logicalDevice, &bufferInfo, nullptr, &buffer);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create uniform ring buffer!");
+	}
+
+	allocateMemory();
+
+	// Map the whole buffer once, every frame writes straight into it
+	result = vkMapMemory(logicalDevice, memory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&mapped));
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to map uniform ring memory!");
+	}
+}
+
+void UniformBufferRing::CleanUp()
+{
+	if (mapped != nullptr) {
+		vkUnmapMemory(logicalDevice, memory);
+		mapped = nullptr;
+	}
+
+	vkDestroyBuffer(logicalDevice, buffer, nullptr);
+	vkFreeMemory(logicalDevice, memory, nullptr);
+	buffer = VK_NULL_HANDLE;
+	memory = VK_NULL_HANDLE;
+}
+
+void UniformBufferRing::BeginFrame(uint32_t frameIndex)
+{
+	// Caller has waited on this frame's fence, so the GPU is done reading everything in the region
+	currentFrame = frameIndex;
+	regionHead = 0;
+	frameStats[currentFrame].bytesUsed = 0;
+}
+
+UniformAllocation UniformBufferRing::Allocate(VkDeviceSize size)
+{
+	if (size > maxAllocationSize) {
+		throw std::runtime_error("Uniform ring allocation larger than the descriptor range!");
+	}
+
+	VkDeviceSize offset = alignUp(regionHead, offsetAlignment);
+	if (offset + size > regionSize) {
+		throw std::runtime_error("Uniform ring is out of space for this frame!");
+	}
+
+	regionHead = offset + size;
+
+	// Track usage for this frame and the worst case seen so far
+	UniformRingFrameStats& stats = frameStats[currentFrame];
+	stats.bytesUsed = regionHead;
+	stats.highWaterMark = std::max(stats.highWaterMark, regionHead);
+
+	VkDeviceSize bufferOffset = regionSize * currentFrame + offset;
+
+	UniformAllocation allocation = {};
+	allocation.data = mapped + bufferOffset;
+	allocation.dynamicOffset = static_cast<uint32_t>(bufferOffset);
+	allocation.size = size;
+
+	return allocation;
+}
+
+void UniformBufferRing::EndFrame()
+{
+	// Coherent memory is visible to the device as soon as it's written
+	if (hostCoherent || regionHead == 0) {
+		return;
+	}
+
+	// Flushed range must start and end on nonCoherentAtomSize boundaries (or end at the end of the memory)
+	VkDeviceSize start = regionSize * currentFrame;
+	VkDeviceSize end = start + alignUp(regionHead, atomSize);
+
+	VkMappedMemoryRange range = {};
+	range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+	range.memory = memory;
+	range.offset = start;
+	range.size = end >= bufferSize ? VK_WHOLE_SIZE : end - start;
+
+	vkFlushMappedMemoryRanges(logicalDevice, 1, &range);
+}
+
+VkDeviceSize UniformBufferRing::alignUp(VkDeviceSize value, VkDeviceSize alignment) const
+{
+	if (alignment == 0) {
+		return value;
+	}
+
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+void UniformBufferRing::allocateMemory()
+{
+	VkMemoryRequirements memoryRequirements;
+	vkGetBufferMemoryRequirements(logicalDevice, buffer, &memoryRequirements);
+
+	// Prefer memory the GPU reads at full speed but the CPU can still write directly
+	VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	uint32_t memoryTypeIndex = findMemoryTypeIndex(physicalDevice, memoryRequirements.memoryTypeBits, properties);
+
+	// Otherwise fall back to plain host memory, which every implementation has
+	if (memoryTypeIndex == UINT32_MAX) {
+		properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		memoryTypeIndex = findMemoryTypeIndex(physicalDevice, memoryRequirements.memoryTypeBits, properties);
+	}
+
+	if (memoryTypeIndex == UINT32_MAX) {
+		throw std::runtime_error("Failed to find host visible memory for uniform ring!");
+	}
+
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+	VkMemoryPropertyFlags typeFlags = memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+	deviceLocal = (typeFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0;
+	hostCoherent = (typeFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+
+	VkMemoryAllocateInfo memoryAllocInfo = {};
+	memoryAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memoryAllocInfo.allocationSize = memoryRequirements.size;
+	memoryAllocInfo.memoryTypeIndex = memoryTypeIndex;
+
+	VkResult result = vkAllocateMemory(logicalDevice, &memoryAllocInfo, nullptr, &memory);
+	if (result != VK_SUCCESS) {
+		// DEVICE_LOCAL | HOST_VISIBLE heaps can be small (e.g. 256MB BAR), so retry in host memory before giving up
+		if (deviceLocal) {
+			properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+			memoryAllocInfo.memoryTypeIndex = findMemoryTypeIndex(physicalDevice, memoryRequirements.memoryTypeBits, properties);
+			if (memoryAllocInfo.memoryTypeIndex != UINT32_MAX) {
+				result = vkAllocateMemory(logicalDevice, &memoryAllocInfo, nullptr, &memory);
+				deviceLocal = false;
+				hostCoherent = true;
+			}
+		}
+
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error("Failed to allocate uniform ring memory!");
+		}
+	}
+
+	vkBindBufferMemory(logicalDevice, buffer, memory, 0);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdexcept>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#include "Utilities.h"
+
+// A piece of the ring handed out for the current frame
+struct UniformAllocation {
+	void* data;							// Persistently mapped pointer to write the constants to
+	uint32_t dynamicOffset;				// Offset to pass to vkCmdBindDescriptorSets for a UNIFORM_BUFFER_DYNAMIC binding
+	VkDeviceSize size;					// Size requested by the caller
+};
+
+struct UniformRingFrameStats {
+	VkDeviceSize bytesUsed = 0;			// Bytes handed out so far in the frame (including alignment padding)
+	VkDeviceSize highWaterMark = 0;		// Most bytes this frame region has ever needed
+};
+
+// Linear per-frame allocator over one persistently mapped uniform buffer.
+// The buffer is split into one region per frame in flight. A region is only rewound in BeginFrame,
+// which must be called after the fence of the frame that last used that region has signalled.
+class UniformBufferRing
+{
+public:
+	UniformBufferRing();
+	~UniformBufferRing();
+
+	void init(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkDeviceSize bytesPerFrame, VkDeviceSize maxAllocationSize, uint32_t framesInFlight);
+	void CleanUp();
+
+	// - Frame Functions
+	void BeginFrame(uint32_t frameIndex);
+	UniformAllocation Allocate(VkDeviceSize size);
+	void EndFrame();
+
+	template<typename T>
+	UniformAllocation Push(const T& value) {
+		UniformAllocation allocation = Allocate(sizeof(T));
+		memcpy(allocation.data, &value, sizeof(T));
+		return allocation;
+	}
+
+	// - Get Functions
+	VkBuffer getBuffer() const { return buffer; }
+	VkDeviceSize getDescriptorRange() const { return maxAllocationSize; }
+	VkDeviceSize getBufferSize() const { return bufferSize; }
+	VkDeviceSize getOffsetAlignment() const { return offsetAlignment; }
+	bool isDeviceLocal() const { return deviceLocal; }
+	const UniformRingFrameStats& getFrameStats(uint32_t frameIndex) const { return frameStats[frameIndex]; }
+
+private:
+	VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+	VkDevice logicalDevice = VK_NULL_HANDLE;
+
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	uint8_t* mapped = nullptr;			// Mapped once in init and left mapped until CleanUp
+
+	bool deviceLocal = false;			// Memory is HOST_VISIBLE | DEVICE_LOCAL (resizable BAR / UMA)
+	bool hostCoherent = false;			// If not coherent, written ranges are flushed in EndFrame
+
+	VkDeviceSize offsetAlignment = 0;	// minUniformBufferOffsetAlignment
+	VkDeviceSize atomSize = 0;			// nonCoherentAtomSize
+	VkDeviceSize regionSize = 0;		// Bytes reserved for each frame in flight
+	VkDeviceSize maxAllocationSize = 0;	// Range of the dynamic uniform buffer descriptor
+	VkDeviceSize bufferSize = 0;
+
+	uint32_t currentFrame = 0;
+	VkDeviceSize regionHead = 0;		// Next free byte in the current region (relative to the region start)
+	std::vector<UniformRingFrameStats> frameStats;
+
+	// - Support Functions
+	VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) const;
+	void allocateMemory();
+};
@@ -1,18 +1,45 @@
 #pragma once
 
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "ObjectLifetimes.h"
+
+const int MAX_FRAME_DRAWS = 2;					// Number of frames the CPU may record ahead of the GPU
+const int MAX_WINDOWS = 16;						// Windows presented together by one renderer
+const VkDeviceSize UNIFORM_RING_FRAME_SIZE = 64 * 1024;	// Bytes of uniform data each frame in flight can allocate
+const VkDeviceSize MAX_UNIFORM_ALLOCATION = 256;		// Largest single uniform allocation (range of the dynamic descriptor)
+
 const std::vector<const char*> deviceExtensions = {
 	VK_KHR_SWAPCHAIN_EXTENSION_NAME
 };
 
+// Optional extensions, enabled together when the device supports them, to pace frames against the display
+const std::vector<const char*> presentWaitExtensions = {
+	VK_KHR_PRESENT_ID_EXTENSION_NAME,
+	VK_KHR_PRESENT_WAIT_EXTENSION_NAME
+};
+
+const int PRESENT_HISTORY_SIZE = 16;			// Input timestamps kept for presents that haven't reached the display yet
+
+const int COMPUTE_BATCHES_IN_FLIGHT = 3;		// Compute batches that can be loading, processing and reading back at once
+const char* const PIPELINE_CACHE_FILE = "pipeline_cache.bin";		// Pipeline cache kept between runs, in the executable's directory
+
 // Indices (locations) of Queue Families (if they exist at all)
 struct QueueFamilyIndices {
-	int graphicsFamily = -1;
+	int graphicsFamily = -1;	 // Location of graphics queue family (compute-only mode: the second queue's family, if any)
 	int presentationFamily = -1; // Location of presentation queue family
+	int computeFamily = -1;		 // Location of compute queue family (compute-only mode)
 
 	// Check if queue families are valid
 	bool isValid() {
 		return graphicsFamily >= 0 && presentationFamily >= 0;
 	}
+
+	bool isComputeValid() {
+		return computeFamily >= 0;
+	}
 };
 
 struct SwapChainDetails {
@@ -22,6 +49,100 @@ struct SwapChainDetails {
 };
 
 struct SwapchainImage {
-	VkImage image;
-	VkImageView imageView;
-};
\ No newline at end of file
+	VkImage image;									// Owned by the swapchain
+	UniqueHandle<VkImageView> imageView;
+	UniqueHandle<VkFramebuffer> framebuffer;		// Only when cleared with a render pass
+};
+
+// Constants written into the uniform ring once per frame
+struct FrameUniforms {
+	float time;
+	uint32_t frameNumber;
+};
+
+// Find the index of a memory type that is allowed by the resource (allowedTypes) and has all of the requested properties
+// Returns UINT32_MAX if no such memory type exists, so callers can try a fallback set of properties
+static uint32_t findMemoryTypeIndex(VkPhysicalDevice physicalDevice, uint32_t allowedTypes, VkMemoryPropertyFlags properties)
+{
+	// Get properties of physical device memory
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+	for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+		if ((allowedTypes & (1 << i))																// Index of memory type must match corresponding bit in allowedTypes
+			&& (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {		// Desired property bit flags are part of memory type's property flags
+			return i;
+		}
+	}
+
+	return UINT32_MAX;
+}
+
+static void createBuffer(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize bufferSize, VkBufferUsageFlags bufferUsage,
+	VkMemoryPropertyFlags bufferProperties, VkBuffer* buffer, VkDeviceMemory* bufferMemory)
+{
+	// CREATE BUFFER
+	// Information to create a buffer (doesn't include assigning memory)
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = bufferSize;									// Size of buffer in bytes
+	bufferInfo.usage = bufferUsage;									// Multiple types of buffer possible
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;				// Only used by one queue family at a time
+
+	VkResult result = vkCreateBuffer(device, &bufferInfo, nullptr, buffer);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Buffer!");
+	}
+
+	// GET BUFFER MEMORY REQUIREMENTS
+	VkMemoryRequirements memRequirements;
+	vkGetBufferMemoryRequirements(device, *buffer, &memRequirements);
+
+	uint32_t memoryTypeIndex = findMemoryTypeIndex(physicalDevice, memRequirements.memoryTypeBits, bufferProperties);
+	if (memoryTypeIndex == UINT32_MAX) {
+		throw std::runtime_error("Failed to find a suitable memory type for Buffer!");
+	}
+
+	// ALLOCATE MEMORY TO BUFFER
+	VkMemoryAllocateInfo memoryAllocInfo = {};
+	memoryAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memoryAllocInfo.allocationSize = memRequirements.size;
+	memoryAllocInfo.memoryTypeIndex = memoryTypeIndex;				// Index of memory type on Physical Device that has required bit flags
+
+	// Allocate memory to VkDeviceMemory
+	result = vkAllocateMemory(device, &memoryAllocInfo, nullptr, bufferMemory);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to allocate Buffer Memory!");
+	}
+
+	// Allocate memory to given buffer
+	vkBindBufferMemory(device, *buffer, *bufferMemory, 0);
+}
+
+static std::vector<char> readFile(const std::string& filename)
+{
+	// Open stream from given file
+	// std::ios::binary tells stream to read file as binary
+	// std::ios::ate tells stream to start reading from end of file
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+
+	// Check if file stream successfully opened
+	if (!file.is_open()) {
+		throw std::runtime_error("Failed to open a file: " + filename);
+	}
+
+	// Get current read position and use to resize file buffer
+	size_t fileSize = (size_t)file.tellg();
+	std::vector<char> fileBuffer(fileSize);
+
+	// Move read position (seek to) the start of the file
+	file.seekg(0);
+
+	// Read the file data into the buffer (stream "fileSize" in total)
+	file.read(fileBuffer.data(), fileSize);
+
+	// Close stream
+	file.close();
+
+	return fileBuffer;
+}
@@ -0,0 +1,95 @@
+#include "ViewportBenchmark.h"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "VulkanRenderer.h"
+
+// Frames run before timing each step, so swapchain creation and the first acquires aren't counted
+static const int BENCHMARK_WARMUP_FRAMES = 30;
+
+static GLFWwindow* createBenchmarkWindow(int index)
+{
+	std::string name = "Viewport " + std::to_string(index);
+
+	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+	glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+
+	GLFWwindow* window = glfwCreateWindow(320, 240, name.c_str(), nullptr, nullptr);
+	if (window != nullptr) {
+		// Cascade so every viewport is visible, an occluded window may not present at full rate
+		glfwSetWindowPos(window, 40 + (index % 8) * 340, 40 + (index / 8) * 270);
+	}
+
+	return window;
+}
+
+int runViewportBenchmark(int maxViewports, int framesPerStep)
+{
+	using Clock = std::chrono::steady_clock;
+
+	std::vector<GLFWwindow*> windows;
+	VulkanRenderer renderer;
+
+	windows.push_back(createBenchmarkWindow(0));
+	if (windows[0] == nullptr || renderer.init(windows[0]) == EXIT_FAILURE) {
+		return EXIT_FAILURE;
+	}
+
+	// Uncapped, no present waits: the numbers should show CPU and submission cost, not the display rate
+	renderer.setPresentLatencyMode(PresentLatencyMode::Throughput);
+
+	printf("Viewport benchmark: %d frames per step, one device, one present per frame\n", framesPerStep);
+	printf("%10s %14s %18s %12s\n", "viewports", "ms/frame", "ms/viewport", "fps");
+
+	int result = EXIT_SUCCESS;
+	for (int viewports = 1; viewports <= maxViewports; viewports++) {
+		// -- ADD VIEWPORT --
+		while (static_cast<int>(renderer.getWindowCount()) < viewports) {
+			GLFWwindow* window = createBenchmarkWindow(static_cast<int>(windows.size()));
+			if (window == nullptr || renderer.addWindow(window) == EXIT_FAILURE) {
+				if (window != nullptr) {
+					glfwDestroyWindow(window);
+				}
+				result = EXIT_FAILURE;
+				break;
+			}
+			windows.push_back(window);
+		}
+
+		if (result == EXIT_FAILURE) {
+			break;
+		}
+
+		// -- WARM UP --
+		for (int i = 0; i < BENCHMARK_WARMUP_FRAMES; i++) {
+			glfwPollEvents();
+			renderer.draw();
+		}
+
+		// -- TIME FRAMES --
+		Clock::time_point start = Clock::now();
+		for (int i = 0; i < framesPerStep; i++) {
+			glfwPollEvents();
+			renderer.draw();
+		}
+		double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+		double msPerFrame = seconds * 1000.0 / framesPerStep;
+		printf("%10d %14.3f %18.3f %12.1f\n", viewports, msPerFrame, msPerFrame / viewports, framesPerStep / seconds);
+	}
+
+	renderer.CleanUp();
+
+	for (GLFWwindow* window : windows) {
+		glfwDestroyWindow(window);
+	}
+
+	return result;
+}
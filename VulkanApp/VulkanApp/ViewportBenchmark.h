@@ -0,0 +1,6 @@
+#pragma once
+
+// Opens 1..maxViewports windows on one device and times framesPerStep frames at each count.
+// Every window is presented in the same vkQueuePresentKHR, so cost per viewport should fall as the count grows.
+// GLFW must already be initialised. Returns EXIT_SUCCESS or EXIT_FAILURE.
+int runViewportBenchmark(int maxViewports, int framesPerStep);
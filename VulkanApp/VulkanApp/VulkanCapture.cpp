@@ -0,0 +1,262 @@
+#include "VulkanCapture.h"
+
+#include <cstring>
+#include <algorithm>
+
+#include "Utilities.h"
+
+const VkDeviceSize TRACE_MAX_WRITE_SIZE = 60 * 1024;		// Larger buffer writes are split, record payloads are 16 bit sized
+
+VulkanCapture::VulkanCapture()
+{
+}
+
+VulkanCapture::~VulkanCapture()
+{
+	End();
+}
+
+bool VulkanCapture::Begin(const std::string& path, const char* deviceName, uint32_t framesInFlight)
+{
+	End();
+
+	TraceHeader header = {};
+	header.magic = TRACE_MAGIC;
+	header.version = TRACE_VERSION;
+	header.framesInFlight = framesInFlight;
+	memcpy(header.deviceName, deviceName, std::min(strlen(deviceName), sizeof(header.deviceName) - 1));
+
+	if (!writer.Open(path, header)) {
+		return false;
+	}
+
+	captureStart = std::chrono::steady_clock::now();
+
+	// Everything the frames will reference that already exists
+	for (const auto& buffer : buffers) {
+		WriteCreateUniformBuffer(buffer.second);
+	}
+
+	return true;
+}
+
+void VulkanCapture::End()
+{
+	writer.Close();
+
+	// Swapchain images are re-registered by the next capture
+	images.clear();
+}
+
+void VulkanCapture::RegisterUniformBuffer(VkBuffer buffer, VkDeviceSize size, VkDeviceSize range, VkDeviceSize offsetAlignment)
+{
+	CapturedBuffer capturedBuffer = {};
+	capturedBuffer.id = nextId++;
+	capturedBuffer.size = size;
+	capturedBuffer.range = range;
+	capturedBuffer.offsetAlignment = offsetAlignment;
+	buffers[buffer] = capturedBuffer;
+
+	if (isCapturing()) {
+		WriteCreateUniformBuffer(capturedBuffer);
+	}
+}
+
+void VulkanCapture::RegisterDescriptorSet(VkDescriptorSet descriptorSet, VkBuffer buffer)
+{
+	descriptorSetBuffers[descriptorSet] = buffer;
+}
+
+void VulkanCapture::RegisterImage(VkImage image, VkFormat format, VkExtent2D extent)
+{
+	if (!isCapturing()) {
+		return;
+	}
+
+	// A recreated swapchain can hand back the same handle with a different size, treat that as a new image
+	auto it = images.find(image);
+	if (it != images.end() && it->second.format == format
+		&& it->second.extent.width == extent.width && it->second.extent.height == extent.height) {
+		return;
+	}
+
+	CapturedImage capturedImage = {};
+	capturedImage.id = nextId++;
+	capturedImage.format = format;
+	capturedImage.extent = extent;
+	images[image] = capturedImage;
+
+	TraceCreateImage record = {};
+	record.imageId = capturedImage.id;
+	record.format = static_cast<uint32_t>(format);
+	record.width = extent.width;
+	record.height = extent.height;
+	writer.Write(TraceOp::CreateImage, &record, sizeof(record));
+}
+
+void VulkanCapture::BeginFrame(uint64_t frameNumber)
+{
+	if (!isCapturing()) {
+		return;
+	}
+
+	TraceBeginFrame record = {};
+	record.frameNumber = frameNumber;
+	record.timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - captureStart).count());
+	writer.Write(TraceOp::BeginFrame, &record, sizeof(record));
+}
+
+void VulkanCapture::WriteBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size)
+{
+	// The caller has already written the data, this only records it
+	if (!isCapturing()) {
+		return;
+	}
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	for (VkDeviceSize written = 0; written < size; written += TRACE_MAX_WRITE_SIZE) {
+		VkDeviceSize chunkSize = std::min(size - written, TRACE_MAX_WRITE_SIZE);
+
+		TraceWriteBuffer record = {};
+		record.bufferId = getBufferId(buffer);
+		record.size = static_cast<uint32_t>(chunkSize);
+		record.offset = offset + written;
+		record.baseOffset = offset;
+		writer.Write(TraceOp::WriteBuffer, &record, sizeof(record), bytes + written, static_cast<uint16_t>(chunkSize));
+	}
+}
+
+void VulkanCapture::CmdPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, const VkImageMemoryBarrier& imageBarrier)
+{
+	vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+	if (!isCapturing()) {
+		return;
+	}
+
+	TraceImageBarrier record = {};
+	record.imageId = getImageId(imageBarrier.image);
+	record.oldLayout = static_cast<uint32_t>(imageBarrier.oldLayout);
+	record.newLayout = static_cast<uint32_t>(imageBarrier.newLayout);
+	record.srcStage = srcStage;
+	record.dstStage = dstStage;
+	record.srcAccess = imageBarrier.srcAccessMask;
+	record.dstAccess = imageBarrier.dstAccessMask;
+	writer.Write(TraceOp::CmdImageBarrier, &record, sizeof(record));
+}
+
+void VulkanCapture::CmdClearColorImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout layout, const VkClearColorValue& colour, const VkImageSubresourceRange& range)
+{
+	vkCmdClearColorImage(commandBuffer, image, layout, &colour, 1, &range);
+
+	if (!isCapturing()) {
+		return;
+	}
+
+	TraceClearColorImage record = {};
+	record.imageId = getImageId(image);
+	memcpy(record.colour, colour.float32, sizeof(record.colour));
+	writer.Write(TraceOp::CmdClearColorImage, &record, sizeof(record));
+}
+
+void VulkanCapture::CmdClearWithRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo& renderPassBeginInfo, VkImage image, const VkImageSubresourceRange& range)
+{
+	// Render pass only clears on load, so there is nothing to record between begin and end
+	vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	vkCmdEndRenderPass(commandBuffer);
+
+	if (!isCapturing()) {
+		return;
+	}
+
+	// Traced as the equivalent transfer clear (barrier, clear, barrier to present), so the trace format and
+	// replayer don't need render passes. Replay images are always created as transfer destinations
+	uint32_t imageId = getImageId(image);
+
+	TraceImageBarrier barrierRecord = {};
+	barrierRecord.imageId = imageId;
+	barrierRecord.oldLayout = static_cast<uint32_t>(VK_IMAGE_LAYOUT_UNDEFINED);
+	barrierRecord.newLayout = static_cast<uint32_t>(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	barrierRecord.srcStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	barrierRecord.dstStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	barrierRecord.srcAccess = 0;
+	barrierRecord.dstAccess = VK_ACCESS_TRANSFER_WRITE_BIT;
+	writer.Write(TraceOp::CmdImageBarrier, &barrierRecord, sizeof(barrierRecord));
+
+	TraceClearColorImage clearRecord = {};
+	clearRecord.imageId = imageId;
+	memcpy(clearRecord.colour, renderPassBeginInfo.pClearValues[0].color.float32, sizeof(clearRecord.colour));
+	writer.Write(TraceOp::CmdClearColorImage, &clearRecord, sizeof(clearRecord));
+
+	barrierRecord.oldLayout = static_cast<uint32_t>(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	barrierRecord.newLayout = static_cast<uint32_t>(VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	barrierRecord.dstStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+	barrierRecord.srcAccess = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrierRecord.dstAccess = 0;
+	writer.Write(TraceOp::CmdImageBarrier, &barrierRecord, sizeof(barrierRecord));
+}
+
+void VulkanCapture::CmdBindDescriptorSet(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, VkDescriptorSet descriptorSet, uint32_t dynamicOffset)
+{
+	vkCmdBindDescriptorSets(commandBuffer, bindPoint, layout, 0, 1, &descriptorSet, 1, &dynamicOffset);
+
+	if (!isCapturing()) {
+		return;
+	}
+
+	auto it = descriptorSetBuffers.find(descriptorSet);
+	TraceBindUniformBuffer record = {};
+	record.bufferId = it != descriptorSetBuffers.end() ? getBufferId(it->second) : 0;
+	record.dynamicOffset = dynamicOffset;
+	writer.Write(TraceOp::CmdBindUniformBuffer, &record, sizeof(record));
+}
+
+void VulkanCapture::Flush(QueueScheduler& scheduler)
+{
+	scheduler.Flush();
+
+	if (isCapturing()) {
+		writer.Write(TraceOp::Submit, nullptr, 0);
+	}
+}
+
+VkResult VulkanCapture::QueuePresent(VkQueue queue, const VkPresentInfoKHR& presentInfo, const std::vector<VkImage>& presentedImages)
+{
+	VkResult result = vkQueuePresentKHR(queue, &presentInfo);
+
+	if (isCapturing()) {
+		// Count followed by one id per window, the renderer never has more than MAX_WINDOWS
+		uint32_t record[1 + MAX_WINDOWS];
+		uint32_t imageCount = static_cast<uint32_t>(std::min(presentedImages.size(), static_cast<size_t>(MAX_WINDOWS)));
+		record[0] = imageCount;
+		for (uint32_t i = 0; i < imageCount; i++) {
+			record[1 + i] = getImageId(presentedImages[i]);
+		}
+		writer.Write(TraceOp::Present, record, static_cast<uint16_t>((1 + imageCount) * sizeof(uint32_t)));
+	}
+
+	return result;
+}
+
+void VulkanCapture::WriteCreateUniformBuffer(const CapturedBuffer& buffer)
+{
+	TraceCreateUniformBuffer record = {};
+	record.bufferId = buffer.id;
+	record.range = static_cast<uint32_t>(buffer.range);
+	record.offsetAlignment = static_cast<uint32_t>(buffer.offsetAlignment);
+	record.size = buffer.size;
+	writer.Write(TraceOp::CreateUniformBuffer, &record, sizeof(record));
+}
+
+uint32_t VulkanCapture::getImageId(VkImage image) const
+{
+	// 0 is never handed out, replay skips commands on unknown objects
+	auto it = images.find(image);
+	return it != images.end() ? it->second.id : 0;
+}
+
+uint32_t VulkanCapture::getBufferId(VkBuffer buffer) const
+{
+	auto it = buffers.find(buffer);
+	return it != buffers.end() ? it->second.id : 0;
+}
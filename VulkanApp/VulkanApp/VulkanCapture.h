@@ -0,0 +1,74 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+
+#include "TraceFile.h"
+#include "QueueScheduler.h"
+
+// Thin layer around the Vulkan calls the renderer makes each frame. Every Cmd/Queue function calls
+// straight through to Vulkan, and when a capture is running also appends the call to the trace,
+// with handles swapped for ids. Not capturing costs one branch per call.
+class VulkanCapture
+{
+public:
+	VulkanCapture();
+	~VulkanCapture();
+
+	// Can start at any point: objects registered before the capture began are written first
+	bool Begin(const std::string& path, const char* deviceName, uint32_t framesInFlight);
+	void End();
+	bool isCapturing() const { return writer.isOpen(); }
+
+	// - Object Registration
+	// Uniform buffers and descriptor sets are created once, so are tracked whether capturing or not
+	void RegisterUniformBuffer(VkBuffer buffer, VkDeviceSize size, VkDeviceSize range, VkDeviceSize offsetAlignment);
+	void RegisterDescriptorSet(VkDescriptorSet descriptorSet, VkBuffer buffer);
+
+	// Swapchain images come and go with the swapchain, so are registered each frame, only while capturing
+	void RegisterImage(VkImage image, VkFormat format, VkExtent2D extent);
+
+	// - Captured Calls
+	void BeginFrame(uint64_t frameNumber);
+	void WriteBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+	void CmdPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage, const VkImageMemoryBarrier& imageBarrier);
+	void CmdClearColorImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout layout, const VkClearColorValue& colour, const VkImageSubresourceRange& range);
+	void CmdClearWithRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo& renderPassBeginInfo, VkImage image, const VkImageSubresourceRange& range);
+	void CmdBindDescriptorSet(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, VkDescriptorSet descriptorSet, uint32_t dynamicOffset);
+	// Only the renderer's own command stream is traced, not what other producers enqueued with it
+	void Flush(QueueScheduler& scheduler);
+	VkResult QueuePresent(VkQueue queue, const VkPresentInfoKHR& presentInfo, const std::vector<VkImage>& presentedImages);
+
+	uint64_t getBytesWritten() const { return writer.getBytesWritten(); }
+
+private:
+	struct CapturedImage {
+		uint32_t id;
+		VkFormat format;
+		VkExtent2D extent;
+	};
+
+	struct CapturedBuffer {
+		uint32_t id;
+		VkDeviceSize size;
+		VkDeviceSize range;
+		VkDeviceSize offsetAlignment;
+	};
+
+	TraceWriter writer;
+	std::chrono::steady_clock::time_point captureStart;
+	uint32_t nextId = 1;
+
+	std::map<VkImage, CapturedImage> images;
+	std::map<VkBuffer, CapturedBuffer> buffers;
+	std::map<VkDescriptorSet, VkBuffer> descriptorSetBuffers;
+
+	void WriteCreateUniformBuffer(const CapturedBuffer& buffer);
+	uint32_t getImageId(VkImage image) const;
+	uint32_t getBufferId(VkBuffer buffer) const;
+};
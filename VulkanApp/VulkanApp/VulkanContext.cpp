@@ -0,0 +1,929 @@
+#include "VulkanContext.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef NDEBUG
+const bool enableValidationLayers = false;
+#else 
+const bool enableValidationLayers = true;
+#endif
+
+VulkanContext::VulkanContext()
+{
+}
+
+VulkanContext::~VulkanContext()
+{
+}
+void VulkanContext::CreateInstance(bool headless)
+{
+	this->headless = headless;
+
+	// Information about the application itself
+	// Most data here doesn't affect the program
+	VkApplicationInfo appInfo = {};
+	appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	appInfo.pApplicationName = "Vulkan App";										// Custom name of the app
+	appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);							// Custom version of the app
+	appInfo.pEngineName = "No Engine";												// Custom engine name
+	appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);								// Custom engine version
+	appInfo.apiVersion = VK_API_VERSION_1_3;										// The vulkan version <--- this one does
+
+	// Creation informations for a VKInstance
+	VkInstanceCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	createInfo.pApplicationInfo = &appInfo;
+
+	// TODO: Set up validation layers that instance will use
+	createInfo.enabledLayerCount = 0;
+	createInfo.ppEnabledLayerNames = nullptr;
+
+	// Validation Layers Check
+	if (enableValidationLayers && !CheckValidationLayersSupport()) {
+		throw std::runtime_error("validation layers requested, but not available!");
+	}
+
+	VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo{};
+	if (enableValidationLayers) {
+		createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
+		createInfo.ppEnabledLayerNames = validationLayers.data();
+
+		PopulateDebugMessengerCreateInfo(debugCreateInfo);
+		createInfo.pNext = (VkDebugUtilsMessengerCreateInfoEXT*) &debugCreateInfo;
+	}
+	else {
+		createInfo.enabledLayerCount = 0;
+		createInfo.pNext = nullptr;
+	}
+
+	auto extensions = getRequiredExtensions();
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+	createInfo.ppEnabledExtensionNames = extensions.data();
+
+
+	// Create instance
+	VkResult result = vkCreateInstance(&createInfo, nullptr, &instance);
+
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Vulkan Instance");
+	}
+
+	mainDeletionQueue.push([this]() {
+		vkDestroyInstance(instance, nullptr);
+	});
+
+	SetupDebugMessenger();
+}
+
+VkSurfaceKHR VulkanContext::CreateSurface(GLFWwindow* window)
+{
+	// Create surface (creates a surface create info struct, runs the create surface function, returns result)
+	// Surface is owned by the PresentationSurface for the window, since windows can come and go at runtime
+	VkSurfaceKHR surface;
+	VkResult result = glfwCreateWindowSurface(instance, window, nullptr, &surface);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a surface!");
+	}
+
+	return surface;
+}
+
+void VulkanContext::CreateDevice(VkSurfaceKHR referenceSurface)
+{
+	GetPhysicalDevice(referenceSurface);
+	queueFamilyIndices = getQueueFamilies(mainDevice.physicalDevice, referenceSurface);
+	CreateLogicalDevice();
+	graphicsCommandPool = CreateCommandPool(queueFamilyIndices.graphicsFamily);
+	CreatePipelineCache();
+}
+
+void VulkanContext::CreateComputeDevice(const char* preferredDeviceName)
+{
+	GetComputePhysicalDevice(preferredDeviceName);
+	queueFamilyIndices = getComputeQueueFamilies(mainDevice.physicalDevice);
+	CreateComputeLogicalDevice();
+	computeCommandPool = CreateCommandPool(queueFamilyIndices.computeFamily);
+
+	// A second queue in the compute family can share its pool, one from another family needs its own
+	if (queueFamilyIndices.graphicsFamily == queueFamilyIndices.computeFamily) {
+		graphicsCommandPool = computeCommandPool;
+	}
+	else if (queueFamilyIndices.graphicsFamily >= 0) {
+		graphicsCommandPool = CreateCommandPool(queueFamilyIndices.graphicsFamily);
+	}
+
+	CreatePipelineCache();
+}
+
+void VulkanContext::CleanUp()
+{
+	// Init may have failed before the device was created, then only the instance needs tearing down
+	if (mainDevice.logicalDevice != VK_NULL_HANDLE) {
+		// Wait until no actions being run on device before destroying
+		vkDeviceWaitIdle(mainDevice.logicalDevice);
+
+		// Destroy everything retired at runtime (device is idle, so nothing is in use)
+		lifetimes.CleanUp();
+	}
+
+	// Everything created in init, in reverse order of creation
+	mainDeletionQueue.flush();
+}
+
+bool VulkanContext::CheckSurfaceSupport(VkSurfaceKHR surface)
+{
+	// Every window is presented from the same queue, so that queue's family has to support the surface
+	VkBool32 presentationSupport = VK_FALSE;
+	vkGetPhysicalDeviceSurfaceSupportKHR(mainDevice.physicalDevice, queueFamilyIndices.presentationFamily, surface, &presentationSupport);
+
+	SwapChainDetails swapChainDetails = getSwapChainDetails(surface);
+
+	return presentationSupport && !swapChainDetails.formats.empty() && !swapChainDetails.presentationModes.empty();
+}
+
+SwapChainDetails VulkanContext::getSwapChainDetails(VkSurfaceKHR surface)
+{
+	return getSwapChainDetails(mainDevice.physicalDevice, surface);
+}
+
+void VulkanContext::GetPhysicalDevice(VkSurfaceKHR surface)
+{
+	uint32_t deviceCount = 0;
+	vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+
+	// If no devices available, then none support vulkan!
+	if (deviceCount == 0) {
+		throw std::runtime_error("Can't find GPUs that support");
+	}
+
+	// Get list of Physical Devices
+	std::vector<VkPhysicalDevice> deviceList(deviceCount);
+	vkEnumeratePhysicalDevices(instance, &deviceCount, deviceList.data());
+
+	for (const auto& device : deviceList) {
+		if (CheckDeviceSuitable(device, surface)) {
+			mainDevice.physicalDevice = device;
+			break;
+		}
+	}
+
+	if (mainDevice.physicalDevice == VK_NULL_HANDLE) {
+		throw std::runtime_error("Can't find a GPU that can present to the window!");
+	}
+}
+
+void VulkanContext::GetComputePhysicalDevice(const char* preferredDeviceName)
+{
+	uint32_t deviceCount = 0;
+	vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+
+	if (deviceCount == 0) {
+		throw std::runtime_error("Can't find GPUs that support Vulkan!");
+	}
+
+	std::vector<VkPhysicalDevice> deviceList(deviceCount);
+	vkEnumeratePhysicalDevices(instance, &deviceCount, deviceList.data());
+
+	// Any device with a compute queue will do, but a name (e.g. "llvmpipe" for lavapipe) picks a specific one
+	mainDevice.physicalDevice = VK_NULL_HANDLE;
+	for (const auto& device : deviceList) {
+		if (!getComputeQueueFamilies(device).isComputeValid()) {
+			continue;
+		}
+
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(device, &deviceProperties);
+
+		if (preferredDeviceName == nullptr || strstr(deviceProperties.deviceName, preferredDeviceName) != nullptr) {
+			mainDevice.physicalDevice = device;
+			break;
+		}
+
+		// Remember the first usable device in case the preferred one isn't found
+		if (mainDevice.physicalDevice == VK_NULL_HANDLE) {
+			mainDevice.physicalDevice = device;
+		}
+	}
+
+	if (mainDevice.physicalDevice == VK_NULL_HANDLE) {
+		throw std::runtime_error("Can't find a GPU with a compute queue!");
+	}
+
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(mainDevice.physicalDevice, &deviceProperties);
+	if (preferredDeviceName != nullptr && strstr(deviceProperties.deviceName, preferredDeviceName) == nullptr) {
+		printf("WARNING: No device matching \"%s\", using %s\n", preferredDeviceName, deviceProperties.deviceName);
+	}
+}
+
+void VulkanContext::CreateLogicalDevice()
+{
+	QueueFamilyIndices indices = queueFamilyIndices;
+
+	// Vector for queue creation information, and set for family indices
+	std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+	std::set<int> uniqueQueueFamilies = { indices.graphicsFamily, indices.presentationFamily };
+
+	// Vulkan needs to know how to handle multiple queues, so decide priority (1 = highest priority)
+	// Declared outside the loop so the pointer is still valid when the device is created
+	float priority = 1.0f;
+
+	// Queues the logical device needs to create and info to do so (only 1 for now, will add more later)
+	for (int queueFamilyIndex : uniqueQueueFamilies) {
+		VkDeviceQueueCreateInfo queueCreateInfo = {};
+		queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+		queueCreateInfo.queueFamilyIndex = queueFamilyIndex;								// The index of the family to create a queue from
+		queueCreateInfo.queueCount = 1;														// Number of queues to create
+		queueCreateInfo.pQueuePriorities = &priority;
+
+		queueCreateInfos.push_back(queueCreateInfo);
+	}
+
+	// Information to create logical device (sometimes called 'device')
+	VkDeviceCreateInfo deviceCreateInfo = {};
+	deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	deviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());											// Number of queue create infos
+	deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();									// List of queue create infos so device can create required
+
+	// Optional present pacing extensions, only enabled if the device supports both extensions and their features
+	std::vector<const char*> enabledExtensions(deviceExtensions);
+	presentWaitSupported = CheckPresentWaitSupport(mainDevice.physicalDevice);
+
+	VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+	presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+	presentIdFeatures.presentId = VK_TRUE;
+
+	VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+	presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+	presentWaitFeatures.presentWait = VK_TRUE;
+	presentIdFeatures.pNext = &presentWaitFeatures;
+
+	void* presentWaitChain = nullptr;
+	if (presentWaitSupported) {
+		enabledExtensions.insert(enabledExtensions.end(), presentWaitExtensions.begin(), presentWaitExtensions.end());
+		presentWaitChain = &presentIdFeatures;
+	}
+
+	// Timeline semaphores and vkQueueSubmit2 for the QueueScheduler, which falls back to vkQueueSubmit without them
+	Submit2Features submit2Features;
+	submit2Supported = CheckSubmit2Support(mainDevice.physicalDevice);
+	deviceCreateInfo.pNext = submit2Supported ? ChainSubmit2Features(submit2Features, presentWaitChain, enabledExtensions) : presentWaitChain;
+
+	deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());		// Number of enabled logical device extensions
+	deviceCreateInfo.ppEnabledExtensionNames = enabledExtensions.data();							// List of enabled logical device extensions
+	
+	
+	VkPhysicalDeviceFeatures deviceFeatures = {};
+
+
+	deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
+
+
+	// Create the logical device for the given physical device
+	VkResult result = vkCreateDevice(mainDevice.physicalDevice, &deviceCreateInfo, nullptr, &mainDevice.logicalDevice);
+
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Logical Device!");
+	}
+
+	mainDeletionQueue.push([this]() {
+		vkDestroyDevice(mainDevice.logicalDevice, nullptr);
+	});
+
+	lifetimes.init(mainDevice.logicalDevice, MAX_FRAME_DRAWS);
+
+	// Queues are created at the same time as the device...
+	// So we want handle to queues
+	// From given logical device of given queue family, of given queue index (0 since only one queue), place reference in given VkQueue 
+	vkGetDeviceQueue(mainDevice.logicalDevice, indices.graphicsFamily, 0, &graphicsQueue);
+	vkGetDeviceQueue(mainDevice.logicalDevice, indices.presentationFamily, 0, &presentationQueue);
+
+	// Extension function, so has to be loaded manually
+	if (presentWaitSupported) {
+		pfnWaitForPresentKHR = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(mainDevice.logicalDevice, "vkWaitForPresentKHR");
+		presentWaitSupported = pfnWaitForPresentKHR != nullptr;
+	}
+
+	LoadSubmit2Function();
+}
+
+void VulkanContext::CreateComputeLogicalDevice()
+{
+	// No window system extensions: nothing is ever presented
+	// Batch jobs and replay only use the compute queue, the second queue (if the device has one) gives the
+	// QueueScheduler a separate Graphics lane, so the submit benchmark gets cross-queue dependencies
+	float priorities[] = { 1.0f, 1.0f };
+	bool sameFamily = queueFamilyIndices.graphicsFamily == queueFamilyIndices.computeFamily;
+
+	std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+
+	VkDeviceQueueCreateInfo queueCreateInfo = {};
+	queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	queueCreateInfo.queueFamilyIndex = queueFamilyIndices.computeFamily;					// The index of the family to create a queue from
+	queueCreateInfo.queueCount = sameFamily ? 2 : 1;										// Number of queues to create
+	queueCreateInfo.pQueuePriorities = priorities;
+	queueCreateInfos.push_back(queueCreateInfo);
+
+	if (queueFamilyIndices.graphicsFamily >= 0 && !sameFamily) {
+		queueCreateInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily;
+		queueCreateInfo.queueCount = 1;
+		queueCreateInfos.push_back(queueCreateInfo);
+	}
+
+	VkPhysicalDeviceFeatures deviceFeatures = {};
+
+	VkDeviceCreateInfo deviceCreateInfo = {};
+	deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	deviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
+	deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
+	deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
+
+	// Optional here: batch jobs and replay only use vkQueueSubmit, the QueueScheduler needs these
+	// No window system extensions, but a 1.2 device may still need VK_KHR_synchronization2
+	std::vector<const char*> enabledExtensions;
+	Submit2Features submit2Features;
+	submit2Supported = CheckSubmit2Support(mainDevice.physicalDevice);
+	if (submit2Supported) {
+		deviceCreateInfo.pNext = ChainSubmit2Features(submit2Features, nullptr, enabledExtensions);
+	}
+
+	deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+	deviceCreateInfo.ppEnabledExtensionNames = enabledExtensions.empty() ? nullptr : enabledExtensions.data();
+
+	VkResult result = vkCreateDevice(mainDevice.physicalDevice, &deviceCreateInfo, nullptr, &mainDevice.logicalDevice);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Logical Device!");
+	}
+
+	mainDeletionQueue.push([this]() {
+		vkDestroyDevice(mainDevice.logicalDevice, nullptr);
+	});
+
+	lifetimes.init(mainDevice.logicalDevice, COMPUTE_BATCHES_IN_FLIGHT);
+
+	vkGetDeviceQueue(mainDevice.logicalDevice, queueFamilyIndices.computeFamily, 0, &computeQueue);
+	graphicsQueue = VK_NULL_HANDLE;
+	presentationQueue = VK_NULL_HANDLE;
+
+	if (queueFamilyIndices.graphicsFamily >= 0) {
+		vkGetDeviceQueue(mainDevice.logicalDevice, queueFamilyIndices.graphicsFamily, sameFamily ? 1 : 0, &graphicsQueue);
+	}
+
+	LoadSubmit2Function();
+}
+
+void* VulkanContext::ChainSubmit2Features(Submit2Features& submit2Features, void* next, std::vector<const char*>& enabledExtensions)
+{
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(mainDevice.physicalDevice, &deviceProperties);
+
+	submit2Features.vulkan12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	submit2Features.vulkan12.timelineSemaphore = VK_TRUE;
+
+	// synchronization2 is core in 1.3, a 1.2 device gets it from the extension instead
+	if (deviceProperties.apiVersion >= VK_API_VERSION_1_3) {
+		submit2Features.vulkan13.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+		submit2Features.vulkan13.synchronization2 = VK_TRUE;
+		submit2Features.vulkan13.pNext = next;
+		submit2Features.vulkan12.pNext = &submit2Features.vulkan13;
+	}
+	else {
+		submit2Features.synchronization2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+		submit2Features.synchronization2.synchronization2 = VK_TRUE;
+		submit2Features.synchronization2.pNext = next;
+		submit2Features.vulkan12.pNext = &submit2Features.synchronization2;
+		enabledExtensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+	}
+
+	return &submit2Features.vulkan12;
+}
+
+void VulkanContext::LoadSubmit2Function()
+{
+	if (!submit2Supported) {
+		return;
+	}
+
+	// Core entry point on 1.3, extension function on 1.2, so has to be loaded manually either way
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(mainDevice.physicalDevice, &deviceProperties);
+	const char* functionName = deviceProperties.apiVersion >= VK_API_VERSION_1_3 ? "vkQueueSubmit2" : "vkQueueSubmit2KHR";
+
+	pfnQueueSubmit2 = (PFN_vkQueueSubmit2)vkGetDeviceProcAddr(mainDevice.logicalDevice, functionName);
+	submit2Supported = pfnQueueSubmit2 != nullptr;
+}
+
+VkCommandPool VulkanContext::CreateCommandPool(int queueFamily)
+{
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;						// Command buffers are re-recorded every frame
+	poolInfo.queueFamilyIndex = queueFamily;												// Queue family type that buffers from this command pool will use
+
+	VkCommandPool commandPool;
+	VkResult result = vkCreateCommandPool(mainDevice.logicalDevice, &poolInfo, nullptr, &commandPool);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Command Pool!");
+	}
+
+	mainDeletionQueue.push([this, commandPool]() {
+		vkDestroyCommandPool(mainDevice.logicalDevice, commandPool, nullptr);
+	});
+
+	return commandPool;
+}
+
+void VulkanContext::CreatePipelineCache()
+{
+	std::string cachePath = getExecutableDirectory() + PIPELINE_CACHE_FILE;
+
+	// Seed from the last run if there is one. The driver checks the header itself and ignores data from
+	// another device or driver version, so a stale file only costs the compile time it would have saved
+	std::vector<char> cacheData;
+	std::ifstream cacheFile(cachePath, std::ios::binary | std::ios::ate);
+	if (cacheFile.is_open()) {
+		cacheData.resize(static_cast<size_t>(cacheFile.tellg()));
+		cacheFile.seekg(0);
+		cacheFile.read(cacheData.data(), cacheData.size());
+		if (cacheFile.fail()) {
+			cacheData.clear();
+		}
+	}
+
+	VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
+	pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	pipelineCacheCreateInfo.initialDataSize = cacheData.size();
+	pipelineCacheCreateInfo.pInitialData = cacheData.empty() ? nullptr : cacheData.data();
+
+	VkResult result = vkCreatePipelineCache(mainDevice.logicalDevice, &pipelineCacheCreateInfo, nullptr, &pipelineCache);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Pipeline Cache!");
+	}
+
+	// Written back on the way out, so pipelines built this run are ready next run
+	mainDeletionQueue.push([this, cachePath]() {
+		size_t dataSize = 0;
+		if (vkGetPipelineCacheData(mainDevice.logicalDevice, pipelineCache, &dataSize, nullptr) == VK_SUCCESS && dataSize > 0) {
+			std::vector<char> data(dataSize);
+			if (vkGetPipelineCacheData(mainDevice.logicalDevice, pipelineCache, &dataSize, data.data()) == VK_SUCCESS) {
+				std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+				file.write(data.data(), dataSize);
+			}
+		}
+
+		vkDestroyPipelineCache(mainDevice.logicalDevice, pipelineCache, nullptr);
+	});
+}
+
+std::string VulkanContext::getExecutableDirectory()
+{
+	// Full path of the running executable, from the OS rather than argv[0] (which may be relative or missing)
+	char path[4096] = {};
+#ifdef _WIN32
+	DWORD length = GetModuleFileNameA(nullptr, path, sizeof(path));
+	if (length == 0 || length >= sizeof(path)) {
+		return "";
+	}
+#else
+	ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+	if (length <= 0) {
+		return "";
+	}
+	path[length] = '\0';
+#endif
+
+	// Keep the trailing separator so file names can be appended directly. Empty falls back to the working directory
+	std::string executablePath(path);
+	size_t separator = executablePath.find_last_of("/\\");
+	return separator == std::string::npos ? "" : executablePath.substr(0, separator + 1);
+}
+
+bool VulkanContext::CheckInstanceExtensionsSupport(std::vector<const char*>* checkExtensions)
+{
+	// Need to get number of extensions to create array of correct size to hold extensions
+	uint32_t extensionsCount = 0;
+	vkEnumerateInstanceExtensionProperties(nullptr, &extensionsCount, nullptr);
+
+	// Create a list of vKExtensionsProperties using count
+	std::vector<VkExtensionProperties> extensions(extensionsCount);
+	vkEnumerateInstanceExtensionProperties(nullptr, &extensionsCount, extensions.data());
+
+	// Check if given extensions are in list of available extensions
+	for (const auto& checkExtension : *checkExtensions) {
+		bool hasExtension = false;
+		for (const auto& extension : extensions) {
+			if (!strcmp(checkExtension, extension.extensionName)) {
+				hasExtension = true;
+				break;
+			}
+			else {
+				printf("Extension name: %s\n", extension.extensionName);
+			}
+		}
+		if (!hasExtension) {
+			
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool VulkanContext::CheckDeviceExtensionSupport(VkPhysicalDevice device)
+{
+	// Get device extension count
+	uint32_t extensionCount = 0;
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+	// If no extensions found, return failure
+	if (extensionCount == 0) {
+		return false;
+	}
+
+	// Populate list of extensions
+	std::vector<VkExtensionProperties> extensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, extensions.data());
+
+	for (const auto& deviceExtension : deviceExtensions) {
+		bool hasExtension = false;
+		for (const auto& extension : extensions) {
+			if (strcmp(deviceExtension, extension.extensionName) == 0) {
+				hasExtension = true;
+				break;
+			}
+		}
+
+		if (!hasExtension) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool VulkanContext::CheckDeviceExtensionAvailable(VkPhysicalDevice device, const char* extensionName)
+{
+	uint32_t extensionCount = 0;
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+	std::vector<VkExtensionProperties> extensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, extensions.data());
+
+	for (const auto& extension : extensions) {
+		if (strcmp(extensionName, extension.extensionName) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool VulkanContext::CheckPresentWaitSupport(VkPhysicalDevice device)
+{
+	for (const auto& extensionName : presentWaitExtensions) {
+		if (!CheckDeviceExtensionAvailable(device, extensionName)) {
+			return false;
+		}
+	}
+
+	// Extensions being listed doesn't mean the features are, so query them too
+	VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+	presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+	VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+	presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+	presentIdFeatures.pNext = &presentWaitFeatures;
+
+	VkPhysicalDeviceFeatures2 features = {};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &presentIdFeatures;
+	vkGetPhysicalDeviceFeatures2(device, &features);
+
+	return presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+}
+
+bool VulkanContext::CheckSubmit2Support(VkPhysicalDevice device)
+{
+	// Timeline semaphores are core in 1.2, synchronization2 is core in 1.3 or comes from VK_KHR_synchronization2 on 1.2
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(device, &deviceProperties);
+	if (deviceProperties.apiVersion < VK_API_VERSION_1_2) {
+		return false;
+	}
+
+	bool synchronization2Core = deviceProperties.apiVersion >= VK_API_VERSION_1_3;
+	if (!synchronization2Core && !CheckDeviceExtensionAvailable(device, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME)) {
+		return false;
+	}
+
+	VkPhysicalDeviceVulkan13Features vulkan13Features = {};
+	vulkan13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+
+	VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features = {};
+	synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+
+	VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	if (synchronization2Core) {
+		vulkan12Features.pNext = &vulkan13Features;
+	}
+	else {
+		vulkan12Features.pNext = &synchronization2Features;
+	}
+
+	VkPhysicalDeviceFeatures2 features = {};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &vulkan12Features;
+	vkGetPhysicalDeviceFeatures2(device, &features);
+
+	VkBool32 synchronization2 = synchronization2Core ? vulkan13Features.synchronization2 : synchronization2Features.synchronization2;
+	return vulkan12Features.timelineSemaphore && synchronization2;
+}
+
+bool VulkanContext::CheckDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface)
+{
+	//// Information about the device itself (ID, name, type, vender, etc)
+	// VkPhysicalDeviceProperties deviceProperties;
+	// vkGetPhysicalDeviceProperties(device, &deviceProperties);
+
+	//// Information about what the device can do (geo shader, tess shdaer, wide lines, etc)
+	// VkPhysicalDeviceFeatures deviceFeatures;
+	// vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
+
+	QueueFamilyIndices indicies = getQueueFamilies(device, surface);
+
+	bool extensionsSupported = CheckDeviceExtensionSupport(device);
+
+	bool swapChainValid = false;
+
+	if (extensionsSupported) {
+		SwapChainDetails swapChainDetails = getSwapChainDetails(device, surface);
+		swapChainValid = !swapChainDetails.presentationModes.empty() && !swapChainDetails.formats.empty();
+	}
+
+	// Timeline semaphores and synchronization2 aren't required, the QueueScheduler falls back to vkQueueSubmit without them
+	return indicies.isValid() && extensionsSupported && swapChainValid;
+}
+
+QueueFamilyIndices VulkanContext::getQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surface)
+{
+	QueueFamilyIndices indices;
+
+	// Get all queue family property info for the given device
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+
+	std::vector<VkQueueFamilyProperties> queueFamilyList(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilyList.data());
+
+	// Go through each queue family and check if it has at least 1 of the required types of queue
+	int i = 0;
+	for (const auto& queueFamily : queueFamilyList) {
+		// First check if queue family has at least 1 queue in that faimly (could have no queues)
+		// Queue can be miltiple types defined through bitfield. need to bitwise AND with VK_QUEUE_*_BIT to check if has required
+		if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+			indices.graphicsFamily = i; // If queue family is valid, then get index
+		}
+
+		// Check if Queue Family supports presentation
+		VkBool32 presentationSupport = false;
+		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentationSupport);
+		// Check if queue is presentation type (can be both graphics and presentation)
+		if (queueFamily.queueCount > 0 && presentationSupport) {
+			indices.presentationFamily = i;
+		}
+
+
+		// Check if queue family indices are in a valid state, stop searching if so
+		if (indices.isValid()) {
+			break;
+		}
+
+		i++;
+	}
+
+	return indices;
+}
+
+QueueFamilyIndices VulkanContext::getComputeQueueFamilies(VkPhysicalDevice device)
+{
+	QueueFamilyIndices indices;
+
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+
+	std::vector<VkQueueFamilyProperties> queueFamilyList(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilyList.data());
+
+	// Prefer a dedicated compute family (no graphics bit), it's usually the async compute hardware queue
+	for (uint32_t i = 0; i < queueFamilyCount; i++) {
+		const VkQueueFamilyProperties& queueFamily = queueFamilyList[i];
+		if (queueFamily.queueCount == 0 || !(queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT)) {
+			continue;
+		}
+
+		if (!(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+			indices.computeFamily = static_cast<int>(i);
+			break;
+		}
+
+		// Otherwise settle for the first family that can do compute
+		if (indices.computeFamily < 0) {
+			indices.computeFamily = static_cast<int>(i);
+		}
+	}
+
+	if (indices.computeFamily < 0) {
+		return indices;
+	}
+
+	// Second queue for the QueueScheduler's Graphics lane, so there is another queue to depend on.
+	// Any other family that can do graphics or compute can run transfers too, otherwise a second queue in the compute family
+	for (uint32_t i = 0; i < queueFamilyCount; i++) {
+		const VkQueueFamilyProperties& queueFamily = queueFamilyList[i];
+		if (static_cast<int>(i) != indices.computeFamily && queueFamily.queueCount > 0 &&
+			queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) {
+			indices.graphicsFamily = static_cast<int>(i);
+			break;
+		}
+	}
+
+	if (indices.graphicsFamily < 0 && queueFamilyList[indices.computeFamily].queueCount > 1) {
+		indices.graphicsFamily = indices.computeFamily;
+	}
+
+	return indices;
+}
+
+SwapChainDetails VulkanContext::getSwapChainDetails(VkPhysicalDevice device, VkSurfaceKHR surface)
+{
+	SwapChainDetails swapChainDetails;
+
+	// -- CAPABILITIES --
+	// Get the surface capabilities for the given surface on the given physical device
+	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &swapChainDetails.surfaceCapabilities);
+
+	// -- FORMATS -- 
+	uint32_t formatCount = 0;
+	vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, nullptr);
+
+	// If formats returns, get list of formats
+	if (formatCount != 0) {
+		swapChainDetails.formats.resize(formatCount);
+		vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, swapChainDetails.formats.data());
+	}
+
+	// -- PRESENTATION MODES --
+	uint32_t presentationCount = 0;
+	vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentationCount, nullptr);
+
+	// If presentation modes returned, get list of presentation modes
+	if (presentationCount != 0) {
+		swapChainDetails.presentationModes.resize(presentationCount);
+		vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentationCount, swapChainDetails.presentationModes.data());
+	}
+
+	return swapChainDetails;
+}
+
+VkImageView VulkanContext::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
+{
+	VkImageViewCreateInfo viewCreateInfo = {};
+	viewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewCreateInfo.image = image;												// Image to create view for
+	viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;							// Type of image (1D, 2D, 3D, cube, etc)
+	viewCreateInfo.format = format;												// Format of image data
+	viewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;				// Allows remapping of rgba components to other rgba
+	viewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+	viewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+	viewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+
+	// Subresources allow the view to view only a part of an image
+	viewCreateInfo.subresourceRange.aspectMask = aspectFlags;					// Which aspect of image to view (e.g. COLOR)BUT
+	viewCreateInfo.subresourceRange.baseMipLevel = 0;							// Start mipmap level to view from
+	viewCreateInfo.subresourceRange.levelCount = 1;								// Number of mipmap levels to view
+	viewCreateInfo.subresourceRange.baseArrayLayer = 0;							// Start array level to view from
+	viewCreateInfo.subresourceRange.layerCount = 1;								// Number of array levels to view
+
+	// Create image view and return it
+	VkImageView imageView;
+	VkResult result = vkCreateImageView(mainDevice.logicalDevice, &viewCreateInfo, nullptr, &imageView);
+
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create an image view!");
+	}
+
+	return imageView;
+}
+
+bool VulkanContext::CheckValidationLayersSupport()
+{
+	uint32_t layerCount;
+	vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
+
+	std::vector<VkLayerProperties> availableLayers(layerCount);
+	vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
+
+	for (const char* layerName : validationLayers) {
+		bool layerFound = false;
+
+		for (const auto& layerProperties : availableLayers) {
+			if (strcmp(layerName, layerProperties.layerName) == 0) {
+				layerFound = true;
+				break;
+			}
+		}
+
+		if (!layerFound) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::vector<const char*> VulkanContext::getRequiredExtensions()
+{
+	std::vector<const char*> extensions;
+
+	// Window system extensions are only needed to present, and GLFW isn't initialised in compute-only mode
+	if (!headless) {
+		uint32_t glfwExtensionCount = 0;
+		const char** glfwExtensions;
+		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+
+		extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	}
+
+	if (enableValidationLayers) {
+		extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+	}
+
+	return extensions;
+}
+
+VKAPI_ATTR VkBool32 VKAPI_CALL VulkanContext::debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData)
+{
+	std::cerr << "Validation layer: " << pCallbackData->pMessage << std::endl;
+
+	return VK_FALSE;
+}
+
+void VulkanContext::SetupDebugMessenger()
+{
+	if (!enableValidationLayers) return;
+
+	VkDebugUtilsMessengerCreateInfoEXT createInfo;
+	PopulateDebugMessengerCreateInfo(createInfo);
+
+	if (CreateDebugUtilsMessengerEXT(instance, &createInfo, nullptr, &debugMessenger) != VK_SUCCESS) {
+		throw std::runtime_error("failed to setup debug messenger!");
+	}
+
+	mainDeletionQueue.push([this]() {
+		DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
+	});
+}
+
+void VulkanContext::PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo)
+{
+	createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+
+	createInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | 
+								 VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
+								 VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+
+	createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
+							 VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+							 VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+
+	createInfo.pfnUserCallback = debugCallback;
+	createInfo.pUserData = nullptr;
+}
+
+VkResult VulkanContext::CreateDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger)
+{
+	auto func = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
+
+	if (func != nullptr) {
+		return func(instance, pCreateInfo, pAllocator, pDebugMessenger);
+	}
+	else {
+		return VK_ERROR_EXTENSION_NOT_PRESENT;
+	}
+}
+
+void VulkanContext::DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMesseneger, const VkAllocationCallbacks* pAllocator)
+{
+	auto func = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT");
+	if (func != nullptr) {
+		func(instance, debugMessenger, pAllocator);
+	}
+}
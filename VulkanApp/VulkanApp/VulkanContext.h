@@ -0,0 +1,156 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdexcept>
+#include <vector>
+#include <iostream>
+#include <set>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <fstream>
+
+#include "Utilities.h"
+
+// Everything that is shared by every window: instance, device, queues and device-wide pools.
+// Per-window presentation state lives in PresentationSurface, so any number of windows can share one device.
+class VulkanContext
+{
+public:
+	VulkanContext();
+	~VulkanContext();
+
+	// Surfaces need an instance, and the device is picked by whether it can present to a surface, so setup is in steps:
+	// CreateInstance -> CreateSurface (per window) -> CreateDevice (with one of those surfaces)
+	// Compute-only mode skips surfaces and swapchains entirely: CreateInstance(true) -> CreateComputeDevice
+	void CreateInstance(bool headless = false);
+	VkSurfaceKHR CreateSurface(GLFWwindow* window);
+	void CreateDevice(VkSurfaceKHR referenceSurface);
+	void CreateComputeDevice(const char* preferredDeviceName = nullptr);
+	void CleanUp();
+
+	// - Surface Functions
+	bool CheckSurfaceSupport(VkSurfaceKHR surface);
+	SwapChainDetails getSwapChainDetails(VkSurfaceKHR surface);
+
+	// - Create Functions
+	VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
+
+	// - Path Functions
+	// Files shipped or saved alongside the executable, found no matter which directory it is started from
+	static std::string getExecutableDirectory();
+
+	// - Get Functions
+	VkInstance getInstance() const { return instance; }
+	VkPhysicalDevice getPhysicalDevice() const { return mainDevice.physicalDevice; }
+	VkDevice getLogicalDevice() const { return mainDevice.logicalDevice; }
+	VkQueue getGraphicsQueue() const { return graphicsQueue; }
+	VkQueue getPresentationQueue() const { return presentationQueue; }
+	const QueueFamilyIndices& getQueueFamilyIndices() const { return queueFamilyIndices; }
+	VkCommandPool getGraphicsCommandPool() const { return graphicsCommandPool; }
+	VkPipelineCache getPipelineCache() const { return pipelineCache; }
+	VkQueue getComputeQueue() const { return computeQueue; }
+	VkCommandPool getComputeCommandPool() const { return computeCommandPool; }
+	bool isHeadless() const { return headless; }
+	bool isPresentWaitSupported() const { return presentWaitSupported; }
+	bool isSubmit2Supported() const { return submit2Supported; }
+	PFN_vkWaitForPresentKHR getWaitForPresentFunction() const { return pfnWaitForPresentKHR; }
+	PFN_vkQueueSubmit2 getQueueSubmit2Function() const { return pfnQueueSubmit2; }
+
+	DeletionQueue& getDeletionQueue() { return mainDeletionQueue; }
+	ObjectLifetimes& getLifetimes() { return lifetimes; }
+
+private:
+	// Vulkan Componenets
+	// - Lifetimes
+	DeletionQueue mainDeletionQueue;						// Objects created in init, destroyed in reverse order in CleanUp
+	ObjectLifetimes lifetimes;								// Objects released at runtime, destroyed once their frames retire
+
+	// - Main
+	VkInstance instance;
+	struct {
+		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+		VkDevice logicalDevice = VK_NULL_HANDLE;
+	} mainDevice;
+	VkQueue graphicsQueue;									// Compute-only: a second queue for the QueueScheduler, if the device has one
+	VkQueue presentationQueue;
+	VkQueue computeQueue = VK_NULL_HANDLE;
+	QueueFamilyIndices queueFamilyIndices;
+	bool headless = false;									// Compute-only: no window system extensions, surfaces or swapchains
+
+	// - Pools
+	VkCommandPool graphicsCommandPool = VK_NULL_HANDLE;		// Compute-only: for the second queue, may be computeCommandPool
+	VkCommandPool computeCommandPool = VK_NULL_HANDLE;
+
+	// - Caches
+	VkPipelineCache pipelineCache = VK_NULL_HANDLE;			// Shared by every pipeline, saved to PIPELINE_CACHE_FILE on CleanUp
+
+	// - Extensions
+	bool presentWaitSupported = false;						// VK_KHR_present_id and VK_KHR_present_wait are enabled
+	PFN_vkWaitForPresentKHR pfnWaitForPresentKHR = nullptr;
+	bool submit2Supported = false;							// Timeline semaphores and synchronization2 (vkQueueSubmit2) are enabled
+	PFN_vkQueueSubmit2 pfnQueueSubmit2 = nullptr;			// vkQueueSubmit2 on 1.3, vkQueueSubmit2KHR on 1.2 + VK_KHR_synchronization2
+
+	// Feature structs for the QueueScheduler, must outlive vkCreateDevice
+	struct Submit2Features {
+		VkPhysicalDeviceVulkan12Features vulkan12 = {};
+		VkPhysicalDeviceVulkan13Features vulkan13 = {};
+		VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2 = {};
+	};
+
+	// - Get Functions
+	void GetPhysicalDevice(VkSurfaceKHR surface);
+	void GetComputePhysicalDevice(const char* preferredDeviceName);
+
+	// Vulkan Functions
+	// - Create Functions
+	void CreateLogicalDevice();
+	void CreateComputeLogicalDevice();
+	VkCommandPool CreateCommandPool(int queueFamily);
+	void CreatePipelineCache();
+	void* ChainSubmit2Features(Submit2Features& submit2Features, void* next, std::vector<const char*>& enabledExtensions);
+	void LoadSubmit2Function();
+
+	// - Support Functions
+	// -- Checker Functions
+	bool CheckInstanceExtensionsSupport(std::vector<const char*>* checkExtensions);
+	bool CheckDeviceExtensionSupport(VkPhysicalDevice device);
+	bool CheckDeviceExtensionAvailable(VkPhysicalDevice device, const char* extensionName);
+	bool CheckPresentWaitSupport(VkPhysicalDevice device);
+	bool CheckSubmit2Support(VkPhysicalDevice device);
+	bool CheckDeviceSuitable(VkPhysicalDevice device, VkSurfaceKHR surface);
+
+	// -- Getter Functions
+	QueueFamilyIndices getQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR surface);
+	QueueFamilyIndices getComputeQueueFamilies(VkPhysicalDevice device);
+	SwapChainDetails getSwapChainDetails(VkPhysicalDevice device, VkSurfaceKHR surface);
+
+	// Validation Layers
+	// - Functions
+	bool CheckValidationLayersSupport();
+
+	std::vector<const char*> getRequiredExtensions();
+
+	static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
+		VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+		VkDebugUtilsMessageTypeFlagsEXT messageType,
+		const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
+		void* pUserData);
+
+	void SetupDebugMessenger();
+	void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
+
+	VkResult CreateDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo,
+		const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger);
+
+	void DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMesseneger, const VkAllocationCallbacks* pAllocator);
+
+	// -- Variables
+	VkDebugUtilsMessengerEXT debugMessenger;
+
+	const std::vector<const char*> validationLayers = {
+		"VK_LAYER_KHRONOS_validation"
+	};
+};
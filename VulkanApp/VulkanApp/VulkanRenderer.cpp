@@ -1,11 +1,5 @@
 #include "VulkanRenderer.h"
 
-#ifdef NDEBUG
-const bool enableValidationLayers = false;
-#else 
-const bool enableValidationLayers = true;
-#endif
-
 VulkanRenderer::VulkanRenderer()
 {
 }
@@ -16,620 +10,585 @@ VulkanRenderer::~VulkanRenderer()
 
 int VulkanRenderer::init(GLFWwindow* newWindow)
 {
-	window = newWindow;
+	VkSurfaceKHR surface = VK_NULL_HANDLE;
 
 	try {
-		CreateInstance();
-		SetupDebugMessenger();
-		CreateSurface();
-		GetPhysicalDevice();
-		CreateLogicalDevice();
-		CreateSwapChain();
+		// The main window's surface is needed to pick a device that can present to it
+		context.CreateInstance();
+		surface = context.CreateSurface(newWindow);
+		context.CreateDevice(surface);
+
+		std::unique_ptr<PresentationSurface> mainSurface(new PresentationSurface());
+		mainSurface->init(&context, newWindow, surface, presentPolicy);
+		surfaces.push_back(std::move(mainSurface));
+		frameLimiter.setTargetFrameRate(surfaces[0]->getPresentSettings().targetFrameRate);
+
+		CreateDescriptorSetLayout();
+		CreatePipelineLayout();
+		CreateCommandBuffers();
+		CreateUniformRing();
+		CreateDescriptorPool();
+		CreateDescriptorSets();
+		CreateSynchronisation();
 	}
 	catch (const std::runtime_error& e) {
 		printf("ERROR: %s\n", e.what());
+
+		// CleanUp is never called after a failed init, so release what was created here: the main window
+		// (or just its surface if it never got one), then the device and instance
+		if (!surfaces.empty()) {
+			for (auto& presentationSurface : surfaces) {
+				presentationSurface->CleanUp();
+			}
+			surfaces.clear();
+		}
+		else if (surface != VK_NULL_HANDLE) {
+			// A failed swapchain init may have retired objects made from the surface, so it goes after them
+			VkInstance instance = context.getInstance();
+			if (context.getLogicalDevice() != VK_NULL_HANDLE) {
+				context.getLifetimes().Retire([instance, surface]() {
+					vkDestroySurfaceKHR(instance, surface, nullptr);
+				});
+			}
+			else {
+				vkDestroySurfaceKHR(instance, surface, nullptr);
+			}
+		}
+
+		context.CleanUp();
 		return EXIT_FAILURE;
 	}
 
 	return 0;
 }
 
-void VulkanRenderer::CleanUp()
+int VulkanRenderer::addWindow(GLFWwindow* newWindow)
 {
-	for (auto image : swapChainImages) {
-		vkDestroyImageView(mainDevice.logicalDevice, image.imageView, nullptr);
-	}
-
-	vkDestroySwapchainKHR(mainDevice.logicalDevice, swapChain, nullptr);
-	vkDestroySurfaceKHR(instance, surface, nullptr);
-
-	if (enableValidationLayers) {
-		DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
+	// Per-frame present data (e.g. the captured present record) is sized for at most MAX_WINDOWS
+	if (surfaces.size() >= MAX_WINDOWS) {
+		printf("ERROR: Can't render to more than %d windows!\n", MAX_WINDOWS);
+		return EXIT_FAILURE;
 	}
 
-	vkDestroyDevice(mainDevice.logicalDevice, nullptr);
-	vkDestroyInstance(instance, nullptr);
-}
+	VkSurfaceKHR surface = VK_NULL_HANDLE;
 
-void VulkanRenderer::GetPhysicalDevice()
-{
-	uint32_t deviceCount = 0;
-	vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+	try {
+		surface = context.CreateSurface(newWindow);
 
-	// If no devices available, then none support vulkan!
-	if (deviceCount == 0) {
-		throw std::runtime_error("Can't find GPUs that support");
+		std::unique_ptr<PresentationSurface> newSurface(new PresentationSurface());
+		newSurface->init(&context, newWindow, surface, presentPolicy);
+		surfaces.push_back(std::move(newSurface));
 	}
+	catch (const std::runtime_error& e) {
+		printf("ERROR: %s\n", e.what());
 
-	// Get list of Physical Devices
-	std::vector<VkPhysicalDevice> deviceList(deviceCount);
-	vkEnumeratePhysicalDevices(instance, &deviceCount, deviceList.data());
-
-	for (const auto& device : deviceList) {
-		if (CheckDeviceSuitable(device)) {
-			mainDevice.physicalDevice = device;
-			break;
+		// Surface never made it into the list, so retire it here (after any swapchain the failed init retired)
+		if (surface != VK_NULL_HANDLE) {
+			VkInstance instance = context.getInstance();
+			context.getLifetimes().Retire([instance, surface]() {
+				vkDestroySurfaceKHR(instance, surface, nullptr);
+			});
 		}
+		return EXIT_FAILURE;
 	}
 
+	return 0;
 }
 
-void VulkanRenderer::CreateInstance()
+void VulkanRenderer::removeWindow(GLFWwindow* window)
 {
-	// Information about the application itself
-	// Most data here doesn't affect the program
-	VkApplicationInfo appInfo = {};
-	appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-	appInfo.pApplicationName = "Vulkan App";										// Custom name of the app
-	appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);							// Custom version of the app
-	appInfo.pEngineName = "No Engine";												// Custom engine name
-	appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);								// Custom engine version
-	appInfo.apiVersion = VK_API_VERSION_1_3;										// The vulkan version <--- this one does
-
-	// Creation informations for a VKInstance
-	VkInstanceCreateInfo createInfo = {};
-	createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-	createInfo.pApplicationInfo = &appInfo;
-
-	// Create list to hold instance extensions
-	std::vector<const char*> instanceExtensions = std::vector<const char*>();
-
-	uint32_t glfwExtensionCount = 0;												// GLFW may require multiple extensions
-	const char** glfwExtensions;													// Extensions passed as arrat of cstrings, so need pointer (the array) to the pointer
-	
-	// Get glfw extensions
-	glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-	// Add glfw extensions to list of extensions
-	for (size_t i = 0; i < glfwExtensionCount; i++) {
-		instanceExtensions.push_back(glfwExtensions[i]);
-	}
-
-	// Check instance extenions supported
-	//if (CheckInstanceExtensionsSupport(&instanceExtensions)) {
-	//	throw std::runtime_error("VkInstance does not support required extensions");
-	//}
-
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(instanceExtensions.size());
-	createInfo.ppEnabledExtensionNames = instanceExtensions.data();
-
-	// TODO: Set up validation layers that instance will use
-	createInfo.enabledLayerCount = 0;
-	createInfo.ppEnabledLayerNames = nullptr;
-
-	// Validation Layers Check
-	if (enableValidationLayers && !CheckValidationLayersSupport()) {
-		throw std::runtime_error("validation layers requested, but not available!");
-	}
-
-	VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo{};
-	if (enableValidationLayers) {
-		createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
-		createInfo.ppEnabledLayerNames = validationLayers.data();
-
-		PopulateDebugMessengerCreateInfo(debugCreateInfo);
-		createInfo.pNext = (VkDebugUtilsMessengerCreateInfoEXT*) &debugCreateInfo;
-	}
-	else {
-		createInfo.enabledLayerCount = 0;
-		createInfo.pNext = nullptr;
-	}
-
-	auto extensions = getRequiredExtensions();
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
-	createInfo.ppEnabledExtensionNames = extensions.data();
-
-
-	// Create instance
-	VkResult result = vkCreateInstance(&createInfo, nullptr, &instance);
-
-	if (result != VK_SUCCESS) {
-		throw std::runtime_error("Failed to create a Vulkan Instance");
+	for (auto it = surfaces.begin(); it != surfaces.end(); ++it) {
+		if ((*it)->getWindow() == window) {
+			// Surface resources are retired, so frames still presenting to the window finish normally
+			(*it)->CleanUp();
+			surfaces.erase(it);
+			return;
+		}
 	}
 }
 
-void VulkanRenderer::CreateLogicalDevice()
+void VulkanRenderer::PaceFrame()
 {
-	QueueFamilyIndices indices = getQueueFamilies(mainDevice.physicalDevice);
-
-	// Vector for queue creation information, and set for family indices
-	std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-	std::set<int> queueFamilyIndices = { indices.graphicsFamily, indices.presentationFamily };
-
-	// Queues the logical device needs to create and info to do so (only 1 for now, will add more later)
-	for (int queueFamilyIndex : queueFamilyIndices) {
-		VkDeviceQueueCreateInfo queueCreateInfo = {};
-		queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-		queueCreateInfo.queueFamilyIndex = indices.graphicsFamily;							// The index of the family to create a queue from
-		queueCreateInfo.queueCount = 1;														// Number of queues to create
-		float priority = 1.0f;
-		queueCreateInfo.pQueuePriorities = &priority;										// Vulkan needs to know how to handle multiple queues, so decide priority (1 = highest priority)
-
-		queueCreateInfos.push_back(queueCreateInfo);
-	}
-
-	// Information to create logical device (sometimes called 'device')
-	VkDeviceCreateInfo deviceCreateInfo = {};
-	deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-	deviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());											// Number of queue create infos
-	deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();									// List of queue create infos so device can create required
-	deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());		// Number of enabled logical device extensions
-	deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions.data();												// List of enabled logical device extensions
-	
-	
-	VkPhysicalDeviceFeatures deviceFeatures = {};
+	using Clock = std::chrono::steady_clock;
 
+	FramePacingStats& stats = pacingStats[static_cast<int>(presentPolicy.getMode())];
 
-	deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
-
-
-	// Create the logical device for the given physical device
-	VkResult result = vkCreateDevice(mainDevice.physicalDevice, &deviceCreateInfo, nullptr, &mainDevice.logicalDevice);
+	if (context.isPresentWaitSupported()) {
+		// -- BOUND PENDING PRESENTS --
+		// Windows are presented together, so waiting on each in turn costs no more than waiting on the slowest
+		for (auto& surface : surfaces) {
+			surface->WaitForPendingPresents(surface->getPresentSettings().maxQueuedPresents);
+		}
 
-	if (result != VK_SUCCESS) {
-		throw std::runtime_error("Failed to create a Logical Device!");
+		// -- MEASURE LATENCY --
+		for (auto& surface : surfaces) {
+			surface->MeasurePresentLatency(stats);
+		}
 	}
 
-	// Queues are created at the same time as the device...
-	// So we want handle to queues
-	// From given logical device of given queue family, of given queue index (0 since only one queue), place reference in given VkQueue 
-	vkGetDeviceQueue(mainDevice.logicalDevice, indices.graphicsFamily, 0, &graphicsQueue);
-	vkGetDeviceQueue(mainDevice.logicalDevice, indices.presentationFamily, 0, &presentationQueue);
-}
+	// -- LIMIT FRAME RATE --
+	frameLimiter.Wait();
 
-void VulkanRenderer::CreateSurface()
-{
-	// Create surface (creates a surface create info struct, runs the create surface function, returns result)
-	VkResult result = glfwCreateWindowSurface(instance, window, nullptr, &surface);
-	if (result != VK_SUCCESS) {
-		std::runtime_error("Failed to create a surface!");
+	// Input is polled straight after this returns, so this is both the frame start and the input sample time
+	Clock::time_point now = Clock::now();
+	if (hasFrameStart) {
+		stats.addFrameTime(std::chrono::duration<double>(now - frameStart).count());
 	}
+
+	frameStart = now;
+	inputSampleTime = now;
+	hasFrameStart = true;
 }
 
-void VulkanRenderer::CreateSwapChain()
+void VulkanRenderer::draw()
 {
-	// Get swao chain details so we can pick best settings
-	SwapChainDetails swapChainDetails = getSwapChainDetails(mainDevice.physicalDevice);
-	
-	// Find optimal surface values for our swap chain
-	VkSurfaceFormatKHR surfaceFormat = chooseBestSurfaceFormat(swapChainDetails.formats);
-	VkPresentModeKHR presentMode = chooseBestPresentationMode(swapChainDetails.presentationModes);
-	VkExtent2D extent = chooseSwapExtent(swapChainDetails.surfaceCapabilities);
-
-	// How many images are in the swapchain? Get 1 more than the minimum to allow tripple buffering
-	uint32_t imageCount = swapChainDetails.surfaceCapabilities.minImageCount + 1;
-
-	// If imageCount higher than max, then clamp down to max
-	// If 0, then limitless
-	if (swapChainDetails.surfaceCapabilities.maxImageCount > 0 && swapChainDetails.surfaceCapabilities.maxImageCount < imageCount) {
-		imageCount = swapChainDetails.surfaceCapabilities.maxImageCount;
+	// Nothing to present to
+	if (surfaces.empty()) {
+		return;
 	}
 
-	// Creation information for swap chain
-	VkSwapchainCreateInfoKHR swapChainCreateInfo = {};
-	swapChainCreateInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-	swapChainCreateInfo.surface = surface;
-	swapChainCreateInfo.imageFormat = surfaceFormat.format;										// Swapchain format
-	swapChainCreateInfo.imageColorSpace = surfaceFormat.colorSpace;								// Swapchain colour space
-	swapChainCreateInfo.presentMode = presentMode;												// Swapchain presentation mode
-	swapChainCreateInfo.imageExtent = extent;													// Swapchain image extents
-	swapChainCreateInfo.minImageCount = imageCount;												// minimum images in swapchain
-	swapChainCreateInfo.imageArrayLayers = 1;													// Number of layers for each image in chain
-	swapChainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;						// What attachment images will be used as
-	swapChainCreateInfo.preTransform = swapChainDetails.surfaceCapabilities.currentTransform;	// Transform to perform on the swapchain
-	swapChainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;						// How to handle blending images with external graphics(e.g. other windows)
-	swapChainCreateInfo.clipped = VK_TRUE;
-
-	// Get Queue Family Indices
-	QueueFamilyIndices indices = getQueueFamilies(mainDevice.physicalDevice);
-
-	// If graphics and presentation families are different, then swapchain must let iamges be shared between families
-	if (indices.graphicsFamily != indices.presentationFamily) {
-
-		uint32_t queueFamilyIndices[] = {
-			(uint32_t)indices.graphicsFamily,
-			(uint32_t)indices.presentationFamily
-		};
-
-		swapChainCreateInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;			// Image share handling
-		swapChainCreateInfo.queueFamilyIndexCount = 2;								// Number of queue to share images between
-		swapChainCreateInfo.pQueueFamilyIndices = queueFamilyIndices;				// Array of queues to share between
-	}
-	else {
-		swapChainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		swapChainCreateInfo.queueFamilyIndexCount = 0;
-		swapChainCreateInfo.pQueueFamilyIndices = nullptr;
-	}
+	// -- WAIT FOR FRAME --
+	// Wait for the GPU to finish with this frame's command buffer and uniform region before touching them again
+	scheduler.Wait(frameTickets[currentFrame]);
 
-	swapChainCreateInfo.oldSwapchain = VK_NULL_HANDLE;
+	// Objects released by frames that have now finished can be destroyed
+	context.getLifetimes().BeginFrame(frameNumber);
 
-	VkResult result = vkCreateSwapchainKHR(mainDevice.logicalDevice, &swapChainCreateInfo, nullptr, &swapChain);
-	if (result != VK_SUCCESS) {
-		throw std::runtime_error("Failed to create swapchain");
-	}
+	capture.BeginFrame(frameNumber);
 
-	// Store for later reference
-	swapChainImageFormat = surfaceFormat.format;
-	swapChainExtent = extent;
+	// -- GET NEXT IMAGES --
+	// One image from every window, each signalling its own semaphore for the frame's commands to wait on. A window
+	// whose swapchain no longer matches its surface (e.g. minimised, display changed) is recreated and left out of this frame
+	std::vector<size_t> frameSurfaces;
+	for (size_t i = 0; i < surfaces.size(); i++) {
+		PresentationSurface& surface = *surfaces[i];
 
-	// Get swap chain images (first count, then values)
-	uint32_t swapChainImageCount;
-	vkGetSwapchainImagesKHR(mainDevice.logicalDevice, swapChain, &swapChainImageCount, nullptr);
-	std::vector<VkImage> images(swapChainImageCount);
-	vkGetSwapchainImagesKHR(mainDevice.logicalDevice, swapChain, &swapChainImageCount, images.data());
+		// Present wait in PaceFrame may already have found the swapchain unusable
+		VkResult result = surface.getPresentWaitResult();
+		if (result == VK_SUCCESS) {
+			result = surface.AcquireNextImage(currentFrame);
+		}
+		else if (result != VK_ERROR_OUT_OF_DATE_KHR) {
+			throw std::runtime_error("Failed to wait for present!");
+		}
 
-	for (VkImage image : images) {
-		// Store image handle
-		SwapchainImage swapChainImage = {};
-		swapChainImage.image = image;
-		swapChainImage.imageView = createImageView(image, swapChainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+		if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+			surface.RecreateSwapChain(presentPolicy);
+			continue;
+		}
+		if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+			throw std::runtime_error("Failed to acquire swapchain image!");
+		}
 
-		// Add to swapchain image list
-		swapChainImages.push_back(swapChainImage);
+		frameSurfaces.push_back(i);
+		scheduler.WaitSemaphore(QueueType::Graphics, surface.getImageAvailable(currentFrame),
+			surface.isClearedWithRenderPass() ? VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT : VK_PIPELINE_STAGE_2_TRANSFER_BIT);
+	}
+
+	// Nothing was acquired (or enqueued), so skip the frame. Its ticket is unchanged, so the next attempt won't block on it
+	if (frameSurfaces.empty()) {
+		return;
+	}
+
+	// -- UPDATE UNIFORMS --
+	// The wait above guarantees the GPU is done with this frame's region of the ring, so it can be rewound
+	uniformRing.BeginFrame(currentFrame);
+
+	FrameUniforms frameUniforms = {};
+	frameUniforms.time = static_cast<float>(glfwGetTime());
+	frameUniforms.frameNumber = frameNumber;
+	UniformAllocation frameAllocation = uniformRing.Push(frameUniforms);
+	capture.WriteBuffer(uniformRing.getBuffer(), frameAllocation.dynamicOffset, &frameUniforms, sizeof(frameUniforms));
+
+	uniformRing.EndFrame();
+
+	RecordCommands(frameAllocation, frameSurfaces);
+
+	// -- SUBMIT COMMAND BUFFER TO RENDER --
+	// Anything else enqueued with the scheduler this frame goes in the same submit call
+	scheduler.SignalSemaphore(QueueType::Graphics, renderFinished[currentFrame]);
+	scheduler.Enqueue(QueueType::Graphics, commandBuffers[currentFrame]);
+
+	// Graphics timeline value once this frame's commands are done, waited on before its resources are reused
+	frameTickets[currentFrame] = scheduler.getLastTicket(QueueType::Graphics);
+	capture.Flush(scheduler);
+
+	// -- PRESENT RENDERED IMAGES TO SCREEN --
+	// Every swapchain goes in one vkQueuePresentKHR
+	std::vector<VkSwapchainKHR> presentSwapChains;
+	std::vector<uint32_t> presentImageIndices;
+	std::vector<VkImage> presentImages;
+	std::vector<uint64_t> presentIds;
+	std::vector<VkResult> presentResults(frameSurfaces.size());
+	for (size_t surfaceIndex : frameSurfaces) {
+		presentSwapChains.push_back(surfaces[surfaceIndex]->getSwapChain());
+		presentImageIndices.push_back(surfaces[surfaceIndex]->getImageIndex());
+		presentImages.push_back(surfaces[surfaceIndex]->getCurrentImage());
+	}
+
+	VkPresentInfoKHR presentInfo = {};
+	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	presentInfo.waitSemaphoreCount = 1;												// Number of semaphores to wait on
+	presentInfo.pWaitSemaphores = &renderFinished[currentFrame];					// Semaphores to wait on
+	presentInfo.swapchainCount = static_cast<uint32_t>(presentSwapChains.size());	// Number of swapchains to present to
+	presentInfo.pSwapchains = presentSwapChains.data();								// Swapchains to present images to
+	presentInfo.pImageIndices = presentImageIndices.data();							// Index of images in swapchains to present
+	presentInfo.pResults = presentResults.data();									// Result for each swapchain
+
+	// Tag each present with an id so PaceFrame can wait on it reaching the display
+	VkPresentIdKHR presentIdInfo = {};
+	if (context.isPresentWaitSupported()) {
+		for (size_t surfaceIndex : frameSurfaces) {
+			presentIds.push_back(surfaces[surfaceIndex]->NextPresentId(inputSampleTime));
+		}
 
+		presentIdInfo.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+		presentIdInfo.swapchainCount = static_cast<uint32_t>(presentIds.size());
+		presentIdInfo.pPresentIds = presentIds.data();
+		presentInfo.pNext = &presentIdInfo;
 	}
-}
 
-bool VulkanRenderer::CheckInstanceExtensionsSupport(std::vector<const char*>* checkExtensions)
-{
-	// Need to get number of extensions to create array of correct size to hold extensions
-	uint32_t extensionsCount = 0;
-	vkEnumerateInstanceExtensionProperties(nullptr, &extensionsCount, nullptr);
-
-	// Create a list of vKExtensionsProperties using count
-	std::vector<VkExtensionProperties> extensions(extensionsCount);
-	vkEnumerateInstanceExtensionProperties(nullptr, &extensionsCount, extensions.data());
-
-	// Check if given extensions are in list of available extensions
-	for (const auto& checkExtension : *checkExtensions) {
-		bool hasExtension = false;
-		for (const auto& extension : extensions) {
-			if (!strcmp(checkExtension, extension.extensionName)) {
-				hasExtension = true;
-				break;
-			}
-			else {
-				printf("Extension name: %s\n", extension.extensionName);
-			}
+	// The overall result is the worst of them, so check each swapchain's own result instead
+	capture.QueuePresent(context.getPresentationQueue(), presentInfo, presentImages);
+	for (size_t i = 0; i < frameSurfaces.size(); i++) {
+		// The frame was still submitted, so only that window's swapchain needs recreating
+		if (presentResults[i] == VK_ERROR_OUT_OF_DATE_KHR) {
+			surfaces[frameSurfaces[i]]->RecreateSwapChain(presentPolicy);
 		}
-		if (!hasExtension) {
-			
-			return false;
+		else if (presentResults[i] != VK_SUCCESS && presentResults[i] != VK_SUBOPTIMAL_KHR) {
+			throw std::runtime_error("Failed to present image!");
 		}
 	}
 
-	return true;
+	// Without present wait the best available measure is input sample to the present call returning
+	if (!context.isPresentWaitSupported()) {
+		double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - inputSampleTime).count();
+		pacingStats[static_cast<int>(presentPolicy.getMode())].addLatency(latency);
+	}
+
+	// Get next frame (use % MAX_FRAME_DRAWS to keep value below MAX_FRAME_DRAWS)
+	currentFrame = (currentFrame + 1) % MAX_FRAME_DRAWS;
+	frameNumber++;
 }
 
-bool VulkanRenderer::CheckDeviceExtensionSupport(VkPhysicalDevice device)
+void VulkanRenderer::setPresentLatencyMode(PresentLatencyMode mode)
 {
-	// Get device extension count
-	uint32_t extensionCount = 0;
-	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+	if (mode == presentPolicy.getMode()) {
+		return;
+	}
 
-	// If no extensions found, return failure
-	if (extensionCount == 0) {
-		return false;
+	presentPolicy.setMode(mode);
+	for (auto& surface : surfaces) {
+		surface->RecreateSwapChain(presentPolicy);
 	}
 
-	// Populate list of extensions
-	std::vector<VkExtensionProperties> extensions(extensionCount);
-	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, extensions.data());
+	if (surfaces.empty()) {
+		return;
+	}
 
-	for (const auto& deviceExtension : deviceExtensions) {
-		bool hasExtension = false;
-		for (const auto& extension : extensions) {
-			if (strcmp(deviceExtension, extension.extensionName) == 0) {
-				hasExtension = true;
-				break;
-			}
-		}
+	const PresentPolicySettings& presentSettings = surfaces[0]->getPresentSettings();
+	frameLimiter.setTargetFrameRate(presentSettings.targetFrameRate);
 
-		if (!hasExtension) {
-			return false;
-		}
-	}
+	// Don't count the swapchain recreation stall as a frame of the new mode
+	hasFrameStart = false;
 
-	return true;
+	printf("Present latency mode: %s (present mode %d, %zu images, %.0f fps cap)\n",
+		presentLatencyModeName(mode), presentSettings.presentMode, surfaces[0]->getImageCount(), presentSettings.targetFrameRate);
 }
 
-bool VulkanRenderer::CheckDeviceSuitable(VkPhysicalDevice device)
+void VulkanRenderer::printPacingReport() const
 {
-	//// Information about the device itself (ID, name, type, vender, etc)
-	// VkPhysicalDeviceProperties deviceProperties;
-	// vkGetPhysicalDeviceProperties(device, &deviceProperties);
-
-	//// Information about what the device can do (geo shader, tess shdaer, wide lines, etc)
-	// VkPhysicalDeviceFeatures deviceFeatures;
-	// vkGetPhysicalDeviceFeatures(device, &deviceFeatures);
+	printf("Frame pacing report (input-to-present measured %s):\n",
+		context.isPresentWaitSupported() ? "to present completion via VK_KHR_present_wait" : "to vkQueuePresentKHR return");
 
-	QueueFamilyIndices indicies = getQueueFamilies(device);
-
-	bool extensionsSupported = CheckDeviceExtensionSupport(device);
-
-	bool swapChainValid = false;
-
-	if (extensionsSupported) {
-		SwapChainDetails swapChainDetails = getSwapChainDetails(device);
-		swapChainValid = !swapChainDetails.presentationModes.empty() && !swapChainDetails.formats.empty();
+	for (int i = 0; i < static_cast<int>(PresentLatencyMode::Count); i++) {
+		pacingStats[i].print(presentLatencyModeName(static_cast<PresentLatencyMode>(i)));
 	}
 
-	return indicies.isValid() && extensionsSupported && swapChainValid;
+	const SubmitStats& submitStats = scheduler.getStats();
+	printf("Queue submits: %llu submit calls over %u frames, %llu batches, %llu command buffers, %.2f us CPU per submit\n",
+		static_cast<unsigned long long>(submitStats.submitCalls), frameNumber, static_cast<unsigned long long>(submitStats.batches),
+		static_cast<unsigned long long>(submitStats.commandBuffers), submitStats.getMicrosecondsPerSubmit());
 }
 
-QueueFamilyIndices VulkanRenderer::getQueueFamilies(VkPhysicalDevice device)
+bool VulkanRenderer::startCapture(const std::string& path)
 {
-	QueueFamilyIndices indices;
-
-	// Get all queue family property info for the given device
-	uint32_t queueFamilyCount = 0;
-	vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
-
-	std::vector<VkQueueFamilyProperties> queueFamilyList(queueFamilyCount);
-	vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilyList.data());
-
-	// Go through each queue family and check if it has at least 1 of the required types of queue
-	int i = 0;
-	for (const auto& queueFamily : queueFamilyList) {
-		// First check if queue family has at least 1 queue in that faimly (could have no queues)
-		// Queue can be miltiple types defined through bitfield. need to bitwise AND with VK_QUEUE_*_BIT to check if has required
-		if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-			indices.graphicsFamily = i; // If queue family is valid, then get index
-		}
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(context.getPhysicalDevice(), &deviceProperties);
 
-		// Check if Queue Family supports presentation
-		VkBool32 presentationSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentationSupport);
-		// Check if queue is presentation type (can be both graphics and presentation)
-		if (queueFamily.queueCount > 0 && presentationSupport) {
-			indices.presentationFamily = i;
-		}
-
-
-		// Check if queue family indices are in a valid state, stop searching if so
-		if (indices.isValid()) {
-			break;
-		}
-
-		i++;
+	if (!capture.Begin(path, deviceProperties.deviceName, MAX_FRAME_DRAWS)) {
+		printf("ERROR: Failed to open capture file %s\n", path.c_str());
+		return false;
 	}
 
-	return indices;
+	printf("Capturing to %s\n", path.c_str());
+	return true;
 }
 
-SwapChainDetails VulkanRenderer::getSwapChainDetails(VkPhysicalDevice device)
+void VulkanRenderer::stopCapture()
 {
-	SwapChainDetails swapChainDetails;
-
-	// -- CAPABILITIES --
-	// Get the surface capabilities for the given surface on the given physical device
-	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &swapChainDetails.surfaceCapabilities);
-
-	// -- FORMATS -- 
-	uint32_t formatCount = 0;
-	vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, nullptr);
-
-	// If formats returns, get list of formats
-	if (formatCount != 0) {
-		swapChainDetails.formats.resize(formatCount);
-		vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, swapChainDetails.formats.data());
-	}
-
-	// -- PRESENTATION MODES --
-	uint32_t presentationCount = 0;
-	vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentationCount, nullptr);
-
-	// If presentation modes returned, get list of presentation modes
-	if (presentationCount != 0) {
-		swapChainDetails.presentationModes.resize(presentationCount);
-		vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentationCount, swapChainDetails.presentationModes.data());
+	if (!capture.isCapturing()) {
+		return;
 	}
 
-	return swapChainDetails;
+	uint64_t bytesWritten = capture.getBytesWritten();
+	capture.End();
+	printf("Capture finished: %.1f KB\n", bytesWritten / 1024.0);
 }
 
-// Best format is subjective, but ours will be:
-// Format		:	VK_FORMAT_R8G8B8A8_UNORM			(VK_FORMAT_B8G8R8A8_UNORM backup value)
-// ColourSpace	:	VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
-VkSurfaceFormatKHR VulkanRenderer::chooseBestSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& formats)
+void VulkanRenderer::CleanUp()
 {
-	// If only 1 format available and is undefined, then this means ALL formats are available (no restrictions)
-	if (formats.size() == 1 && formats[0].format == VK_FORMAT_UNDEFINED) {
-		return { VK_FORMAT_R8G8B8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
-	}
+	stopCapture();
 
-	// If restricted, search for optimal format
-	for (const auto &format : formats) {
-		if ((format.format == VK_FORMAT_R8G8B8A8_UNORM || format.format == VK_FORMAT_B8G8R8A8_UNORM) && format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
-			return format;
-		}
+	// Wait until no actions being run on device before destroying
+	vkDeviceWaitIdle(context.getLogicalDevice());
+
+	// Release every window, then let the context destroy everything (retired objects first, then in reverse order of creation)
+	for (auto& surface : surfaces) {
+		surface->CleanUp();
 	}
+	surfaces.clear();
 
-	return formats[0];
+	context.CleanUp();
 }
 
-VkPresentModeKHR VulkanRenderer::chooseBestPresentationMode(const std::vector<VkPresentModeKHR>& presentationModes)
+void VulkanRenderer::CreateDescriptorSetLayout()
 {
-	for (const auto& presentationMode : presentationModes) {
-		if (presentationMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-			return presentationMode;
-		}
+	// Per-frame constants live in the uniform ring, so the binding is dynamic: one descriptor, offset chosen at bind time
+	VkDescriptorSetLayoutBinding uniformLayoutBinding = {};
+	uniformLayoutBinding.binding = 0;														// Binding point in shader
+	uniformLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;		// Type of descriptor
+	uniformLayoutBinding.descriptorCount = 1;												// Number of descriptors for binding
+	uniformLayoutBinding.stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS;							// Shader stages to bind to
+	uniformLayoutBinding.pImmutableSamplers = nullptr;										// For textures: can make sampler immutable
+
+	VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+	layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutCreateInfo.bindingCount = 1;
+	layoutCreateInfo.pBindings = &uniformLayoutBinding;
+
+	VkResult result = vkCreateDescriptorSetLayout(context.getLogicalDevice(), &layoutCreateInfo, nullptr, &descriptorSetLayout);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Descriptor Set Layout!");
 	}
 
-	// If can't find, use FIFO
-	return VK_PRESENT_MODE_FIFO_KHR;
+	context.getDeletionQueue().push([this]() {
+		vkDestroyDescriptorSetLayout(context.getLogicalDevice(), descriptorSetLayout, nullptr);
+	});
 }
 
-VkExtent2D VulkanRenderer::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& surfaceCapabilities)
+void VulkanRenderer::CreatePipelineLayout()
 {
-	// If current extent is at numeric limits, then extent can vary. Otherwise, it is the size of the window.
-	if (surfaceCapabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
-		return surfaceCapabilities.currentExtent;
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayout;
+	pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
+	pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
+
+	VkResult result = vkCreatePipelineLayout(context.getLogicalDevice(), &pipelineLayoutCreateInfo, nullptr, &pipelineLayout);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create Pipeline Layout!");
 	}
-	else {
 
-		// If value can vary, need to set manually
-
-		// Get window size
-		int width, height;
-		glfwGetFramebufferSize(window, &width, &height);
-
-		// Create new extent using window size
-		VkExtent2D newExtent = {};
-		newExtent.width = static_cast<uint32_t>(width);
-		newExtent.height = static_cast<uint32_t>(height);
-
-		// Surface also defines max and min, so make sure within boundaries by clamping value
-		newExtent.width = std::max(surfaceCapabilities.minImageExtent.width, std::min(surfaceCapabilities.maxImageExtent.width, newExtent.width));
-		newExtent.height = std::max(surfaceCapabilities.minImageExtent.height, std::min(surfaceCapabilities.maxImageExtent.height, newExtent.height));
-	
-		return newExtent;
-	}
+	context.getDeletionQueue().push([this]() {
+		vkDestroyPipelineLayout(context.getLogicalDevice(), pipelineLayout, nullptr);
+	});
 }
 
-VkImageView VulkanRenderer::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
+void VulkanRenderer::CreateCommandBuffers()
 {
-	VkImageViewCreateInfo viewCreateInfo = {};
-	viewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-	viewCreateInfo.image = image;												// Image to create view for
-	viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;							// Type of image (1D, 2D, 3D, cube, etc)
-	viewCreateInfo.format = format;												// Format of image data
-	viewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;				// Allows remapping of rgba components to other rgba
-	viewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
-	viewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
-	viewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
-
-	// Subresources allow the view to view only a part of an image
-	viewCreateInfo.subresourceRange.aspectMask = aspectFlags;					// Which aspect of image to view (e.g. COLOR)BUT
-	viewCreateInfo.subresourceRange.baseMipLevel = 0;							// Start mipmap level to view from
-	viewCreateInfo.subresourceRange.levelCount = 1;								// Number of mipmap levels to view
-	viewCreateInfo.subresourceRange.baseArrayLayer = 0;							// Start array level to view from
-	viewCreateInfo.subresourceRange.layerCount = 1;								// Number of array levels to view
-
-	// Create image view and return it
-	VkImageView imageView;
-	VkResult result = vkCreateImageView(mainDevice.logicalDevice, &viewCreateInfo, nullptr, &imageView);
+	// One command buffer per frame in flight, re-recorded once that frame's ticket has completed
+	commandBuffers.resize(MAX_FRAME_DRAWS);
 
+	VkCommandBufferAllocateInfo cbAllocInfo = {};
+	cbAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	cbAllocInfo.commandPool = context.getGraphicsCommandPool();
+	cbAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;									// PRIMARY: buffer you submit directly to queue
+	cbAllocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+
+	VkResult result = vkAllocateCommandBuffers(context.getLogicalDevice(), &cbAllocInfo, commandBuffers.data());
 	if (result != VK_SUCCESS) {
-		throw std::runtime_error("Failed to create an image view!");
+		throw std::runtime_error("Failed to allocate Command Buffers!");
 	}
-
-	return imageView;
 }
 
-bool VulkanRenderer::CheckValidationLayersSupport()
+void VulkanRenderer::CreateSynchronisation()
 {
-	uint32_t layerCount;
-	vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
+	// Frames are tracked on the scheduler's timelines, an empty ticket counts as complete so the first wait on each frame returns
+	scheduler.init(&context);
+	frameTickets.resize(MAX_FRAME_DRAWS);
 
-	std::vector<VkLayerProperties> availableLayers(layerCount);
-	vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
+	renderFinished.resize(MAX_FRAME_DRAWS);
 
-	for (const char* layerName : validationLayers) {
-		bool layerFound = false;
-
-		for (const auto& layerProperties : availableLayers) {
-			if (strcmp(layerName, layerProperties.layerName) == 0) {
-				layerFound = true;
-				break;
-			}
-		}
+	// Semaphore creation information (image available semaphores belong to each window)
+	VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+	semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-		if (!layerFound) {
-			return false;
+	for (size_t i = 0; i < MAX_FRAME_DRAWS; i++) {
+		if (vkCreateSemaphore(context.getLogicalDevice(), &semaphoreCreateInfo, nullptr, &renderFinished[i]) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create a Semaphore!");
 		}
 	}
 
-	return true;
+	context.getDeletionQueue().push([this]() {
+		for (size_t i = 0; i < MAX_FRAME_DRAWS; i++) {
+			vkDestroySemaphore(context.getLogicalDevice(), renderFinished[i], nullptr);
+		}
+	});
 }
 
-std::vector<const char*> VulkanRenderer::getRequiredExtensions()
+void VulkanRenderer::CreateUniformRing()
 {
-	uint32_t glfwExtensionCount = 0;
-	const char** glfwExtensions;
-	glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	uniformRing.init(context.getPhysicalDevice(), context.getLogicalDevice(), UNIFORM_RING_FRAME_SIZE, MAX_UNIFORM_ALLOCATION, MAX_FRAME_DRAWS);
+	capture.RegisterUniformBuffer(uniformRing.getBuffer(), uniformRing.getBufferSize(), uniformRing.getDescriptorRange(), uniformRing.getOffsetAlignment());
 
-	std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	context.getDeletionQueue().push([this]() {
+		uniformRing.CleanUp();
+	});
+}
 
-	if (enableValidationLayers) {
-		extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+void VulkanRenderer::CreateDescriptorPool()
+{
+	// Only one dynamic uniform buffer descriptor is needed, no matter how many objects are drawn
+	VkDescriptorPoolSize poolSize = {};
+	poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	poolSize.descriptorCount = 1;
+
+	VkDescriptorPoolCreateInfo poolCreateInfo = {};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.maxSets = 1;													// Maximum number of Descriptor Sets that can be created from pool
+	poolCreateInfo.poolSizeCount = 1;											// Amount of Pool Sizes being passed
+	poolCreateInfo.pPoolSizes = &poolSize;										// Pool Sizes to create pool with
+
+	VkResult result = vkCreateDescriptorPool(context.getLogicalDevice(), &poolCreateInfo, nullptr, &descriptorPool);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Descriptor Pool!");
 	}
 
-	return extensions;
+	context.getDeletionQueue().push([this]() {
+		vkDestroyDescriptorPool(context.getLogicalDevice(), descriptorPool, nullptr);
+	});
 }
 
-VKAPI_ATTR VkBool32 VKAPI_CALL VulkanRenderer::debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData)
+void VulkanRenderer::CreateDescriptorSets()
 {
-	std::cerr << "Validation layer: " << pCallbackData->pMessage << std::endl;
+	VkDescriptorSetAllocateInfo setAllocInfo = {};
+	setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	setAllocInfo.descriptorPool = descriptorPool;								// Pool to allocate Descriptor Set from
+	setAllocInfo.descriptorSetCount = 1;										// Number of sets to allocate
+	setAllocInfo.pSetLayouts = &descriptorSetLayout;							// Layouts to use to allocate sets
 
-	return VK_FALSE;
+	VkResult result = vkAllocateDescriptorSets(context.getLogicalDevice(), &setAllocInfo, &uniformDescriptorSet);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to allocate Descriptor Sets!");
+	}
+
+	// Point the descriptor at the ring once, it never needs updating again
+	VkDescriptorBufferInfo uniformBufferInfo = {};
+	uniformBufferInfo.buffer = uniformRing.getBuffer();							// Buffer to get data from
+	uniformBufferInfo.offset = 0;												// Dynamic offset is added to this at bind time
+	uniformBufferInfo.range = uniformRing.getDescriptorRange();					// Size of data visible through the descriptor
+
+	VkWriteDescriptorSet setWrite = {};
+	setWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	setWrite.dstSet = uniformDescriptorSet;										// Descriptor Set to update
+	setWrite.dstBinding = 0;													// Binding to update (matches binding on layout/shader)
+	setWrite.dstArrayElement = 0;												// Index in array to update
+	setWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;		// Type of descriptor
+	setWrite.descriptorCount = 1;												// Amount to update
+	setWrite.pBufferInfo = &uniformBufferInfo;									// Information about buffer data to bind
+
+	vkUpdateDescriptorSets(context.getLogicalDevice(), 1, &setWrite, 0, nullptr);
+	capture.RegisterDescriptorSet(uniformDescriptorSet, uniformRing.getBuffer());
 }
 
-void VulkanRenderer::SetupDebugMessenger()
+void VulkanRenderer::RecordCommands(const UniformAllocation& frameUniforms, const std::vector<size_t>& frameSurfaces)
 {
-	if (!enableValidationLayers) return;
-
-	VkDebugUtilsMessengerCreateInfoEXT createInfo;
-	PopulateDebugMessengerCreateInfo(createInfo);
+	VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
 
-	if (CreateDebugUtilsMessengerEXT(instance, &createInfo, nullptr, &debugMessenger) != VK_SUCCESS) {
-		throw std::runtime_error("failed to setup debug messenger!");
-	}
-}
+	// Information about how to begin each command buffer
+	VkCommandBufferBeginInfo bufferBeginInfo = {};
+	bufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	bufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;		// Re-recorded every frame
 
-void VulkanRenderer::PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo)
-{
-	createInfo = {};
-	createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+	VkResult result = vkBeginCommandBuffer(commandBuffer, &bufferBeginInfo);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to start recording a Command Buffer!");
+	}
+
+	VkImageSubresourceRange colourRange = {};
+	colourRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	colourRange.baseMipLevel = 0;
+	colourRange.levelCount = 1;
+	colourRange.baseArrayLayer = 0;
+	colourRange.layerCount = 1;
+
+	// Bind per-frame constants: the same descriptor set every frame, the dynamic offset picks this frame's slice of the ring
+	capture.CmdBindDescriptorSet(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, uniformDescriptorSet, frameUniforms.dynamicOffset);
+
+	// Tint each window differently so viewports can be told apart
+	const VkClearColorValue clearColours[] = {
+		{ { 0.6f, 0.65f, 0.4f, 1.0f } },
+		{ { 0.4f, 0.55f, 0.65f, 1.0f } },
+		{ { 0.65f, 0.45f, 0.4f, 1.0f } },
+		{ { 0.5f, 0.4f, 0.6f, 1.0f } }
+	};
+
+	for (size_t surfaceIndex : frameSurfaces) {
+		const PresentationSurface& surface = *surfaces[surfaceIndex];
+		const VkClearColorValue& clearColour = clearColours[surfaceIndex % (sizeof(clearColours) / sizeof(clearColours[0]))];
+
+		VkImage image = surface.getCurrentImage();
+		capture.RegisterImage(image, surface.getImageFormat(), surface.getExtent());
+
+		// Surface can't be a transfer destination: clear with the render pass load op instead, which also
+		// transitions the image to be presented
+		if (surface.isClearedWithRenderPass()) {
+			VkClearValue clearValue = {};
+			clearValue.color = clearColour;
+
+			VkRenderPassBeginInfo renderPassBeginInfo = {};
+			renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+			renderPassBeginInfo.renderPass = surface.getClearRenderPass();					// Render pass to begin
+			renderPassBeginInfo.framebuffer = surface.getCurrentFramebuffer();				// Framebuffer of the acquired image
+			renderPassBeginInfo.renderArea.offset = { 0, 0 };								// Start point of render pass in pixels
+			renderPassBeginInfo.renderArea.extent = surface.getExtent();					// Size of region to run render pass on
+			renderPassBeginInfo.clearValueCount = 1;
+			renderPassBeginInfo.pClearValues = &clearValue;
+
+			capture.CmdClearWithRenderPass(commandBuffer, renderPassBeginInfo, image, colourRange);
+			continue;
+		}
 
-	createInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | 
-								 VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
-								 VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+		// Transition swapchain image so it can be cleared (previous contents are discarded)
+		VkImageMemoryBarrier clearBarrier = {};
+		clearBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		clearBarrier.srcAccessMask = 0;
+		clearBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		clearBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		clearBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		clearBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		clearBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		clearBarrier.image = image;
+		clearBarrier.subresourceRange = colourRange;
 
-	createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
-							 VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
-							 VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+		capture.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, clearBarrier);
 
-	createInfo.pfnUserCallback = debugCallback;
-	createInfo.pUserData = nullptr;
-}
+		capture.CmdClearColorImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, clearColour, colourRange);
 
-VkResult VulkanRenderer::CreateDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger)
-{
-	auto func = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
+		// Transition swapchain image to be presented
+		VkImageMemoryBarrier presentBarrier = clearBarrier;
+		presentBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		presentBarrier.dstAccessMask = 0;
+		presentBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		presentBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
-	if (func != nullptr) {
-		return func(instance, pCreateInfo, pAllocator, pDebugMessenger);
-	}
-	else {
-		return VK_ERROR_EXTENSION_NOT_PRESENT;
+		capture.CmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, presentBarrier);
 	}
-}
 
-void VulkanRenderer::DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMesseneger, const VkAllocationCallbacks* pAllocator)
-{
-	auto func = (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT");
-	if (func != nullptr) {
-		func(instance, debugMessenger, pAllocator);
+	result = vkEndCommandBuffer(commandBuffer);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to stop recording a Command Buffer!");
 	}
 }
@@ -7,11 +7,21 @@
 
 #include <stdexcept>
 #include <vector>
+#include <memory>
 #include <iostream>
 #include <set>
 #include <algorithm>
+#include <limits>
+#include <chrono>
 
 #include "Utilities.h"
+#include "VulkanContext.h"
+#include "PresentationSurface.h"
+#include "UniformBufferRing.h"
+#include "PresentPolicy.h"
+#include "FramePacing.h"
+#include "VulkanCapture.h"
+#include "QueueScheduler.h"
 
 class VulkanRenderer
 {
@@ -20,86 +30,79 @@ public:
 	~VulkanRenderer();
 
 	int init(GLFWwindow* newWindow);
+	void PaceFrame();
+	void draw();
 	void CleanUp();
 
-protected:
-
-	
-private:
-	GLFWwindow* window;
-
-	// Vulkan Componenets
-	// - Main
-	VkInstance instance;
-	struct {
-		VkPhysicalDevice physicalDevice;
-		VkDevice logicalDevice;
-	} mainDevice;
-	VkQueue graphicsQueue;
-	VkQueue presentationQueue;
-	VkSurfaceKHR surface;
-	VkSwapchainKHR swapChain;
-	std::vector<SwapchainImage> swapChainImages;
-
-	// - Utility
-	VkFormat swapChainImageFormat;
-	VkExtent2D swapChainExtent;
-
-	// - Get Functions
-	void GetPhysicalDevice();
-
-
-	// Vulkan Functions
-	// - Create Functions
-	void CreateInstance();
-	void CreateLogicalDevice();
-	void CreateSurface();
-	void CreateSwapChain();
+	// - Windows
+	// Extra windows share the device created in init, and are presented with the main window in one vkQueuePresentKHR
+	int addWindow(GLFWwindow* newWindow);
+	void removeWindow(GLFWwindow* window);
+	size_t getWindowCount() const { return surfaces.size(); }
 
-	// - Support Functions
-	// -- Checker Functions
-	bool CheckInstanceExtensionsSupport(std::vector<const char*>* checkExtensions);
-	bool CheckDeviceExtensionSupport(VkPhysicalDevice device);
-	bool CheckDeviceSuitable(VkPhysicalDevice device);
+	void setPresentLatencyMode(PresentLatencyMode mode);
+	PresentLatencyMode getPresentLatencyMode() const { return presentPolicy.getMode(); }
+	void printPacingReport() const;
 
+	const UniformBufferRing& getUniformRing() const { return uniformRing; }
 
-	// -- Getter Functions
-	QueueFamilyIndices getQueueFamilies(VkPhysicalDevice device);
-	SwapChainDetails getSwapChainDetails(VkPhysicalDevice device);
+	// Other subsystems enqueue their command buffers here during a frame, and they go in the frame's submit
+	QueueScheduler& getScheduler() { return scheduler; }
 
-	// -- Choose Functions
-	VkSurfaceFormatKHR chooseBestSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& formats);
-	VkPresentModeKHR chooseBestPresentationMode(const std::vector<VkPresentModeKHR> & presentationModes);
-	VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& surfaceCapabilities);
+	// - Capture
+	// Records every frame's resource writes and command stream to a trace that VulkanReplay can re-issue
+	bool startCapture(const std::string& path);
+	void stopCapture();
 
-	// -- Create Functions
-	VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
-
-	// Validation Layers
-	// - Functions
-	bool CheckValidationLayersSupport();
-
-	std::vector<const char*> getRequiredExtensions();
-
-	static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
-		VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
-		VkDebugUtilsMessageTypeFlagsEXT messageType,
-		const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
-		void* pUserData);
-
-	void SetupDebugMessenger();
-	void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
-
-	VkResult CreateDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo,
-		const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger);
+protected:
 
-	void DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMesseneger, const VkAllocationCallbacks* pAllocator);
 
-	// -- Variables
-	VkDebugUtilsMessengerEXT debugMessenger;
+private:
+	// Vulkan Componenets
+	// - Main
+	VulkanContext context;										// Instance, device, queues and pools shared by every window
+	std::vector<std::unique_ptr<PresentationSurface>> surfaces;	// One per window, surfaces[0] is the main window
+	std::vector<VkCommandBuffer> commandBuffers;				// One per frame in flight
+
+	// - Descriptors
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkDescriptorPool descriptorPool;
+	VkDescriptorSet uniformDescriptorSet;						// Single set, frames select their data with a dynamic offset
+	VkPipelineLayout pipelineLayout;
+
+	// - Uniforms
+	UniformBufferRing uniformRing;
+
+	// - Synchronisation
+	QueueScheduler scheduler;									// Every submit goes through this, one submit call per queue per frame
+	std::vector<VkSemaphore> renderFinished;					// One per frame, waited on by the single present of every window
+	std::vector<SubmitTicket> frameTickets;						// One per frame, where the graphics timeline will be once the frame is done
+	int currentFrame = 0;
+	uint32_t frameNumber = 0;
+
+	// - Presentation
+	PresentPolicy presentPolicy;
+	FrameLimiter frameLimiter;
+
+	// - Pacing Metrics
+	std::chrono::steady_clock::time_point frameStart;
+	std::chrono::steady_clock::time_point inputSampleTime;
+	bool hasFrameStart = false;
+	FramePacingStats pacingStats[static_cast<int>(PresentLatencyMode::Count)];
+
+	// - Capture
+	VulkanCapture capture;							// Every per-frame Vulkan call goes through this
 
-	const std::vector<const char*> validationLayers = {
-		"VK_LAYER_KHRONOS_validation"
-	};	
+	// Vulkan Functions
+	// - Create Functions
+	void CreateDescriptorSetLayout();
+	void CreatePipelineLayout();
+	void CreateCommandBuffers();
+	void CreateSynchronisation();
+	void CreateUniformRing();
+	void CreateDescriptorPool();
+	void CreateDescriptorSets();
+
+	// - Record Functions
+	void RecordCommands(const UniformAllocation& frameUniforms, const std::vector<size_t>& frameSurfaces);
 };
-
@@ -4,8 +4,13 @@
 #include <stdexcept>
 #include <vector>
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
 
 #include "VulkanRenderer.h"
+#include "ViewportBenchmark.h"
+#include "ComputeBatch.h"
+#include "SubmitBenchmark.h"
 
 GLFWwindow* window;
 VulkanRenderer vulkanRenderer;
@@ -24,7 +29,47 @@ void initWindow(std::string wName = "Test Window", const int width = 800, const
 
 }
 
-int main() {
+int main(int argc, char** argv) {
+
+	// --viewport-bench [N]: time rendering to 1..N windows sharing one device, then exit
+	if (argc > 1 && strcmp(argv[1], "--viewport-bench") == 0) {
+		int maxViewports = argc > 2 ? atoi(argv[2]) : 8;
+		if (maxViewports > MAX_WINDOWS) {
+			printf("Viewport benchmark limited to %d windows\n", MAX_WINDOWS);
+			maxViewports = MAX_WINDOWS;
+		}
+
+		glfwInit();
+		int result = runViewportBenchmark(maxViewports > 0 ? maxViewports : 1, 1000);
+		glfwTerminate();
+
+		return result;
+	}
+
+	// --compute-batch [batches] [imagesPerBatch] [device]: compute-only image processing, no window or swapchain
+	if (argc > 1 && strcmp(argv[1], "--compute-batch") == 0) {
+		ComputeBatchSettings settings;
+		if (argc > 2 && atoi(argv[2]) > 0) {
+			settings.batchCount = static_cast<uint32_t>(atoi(argv[2]));
+		}
+		if (argc > 3 && atoi(argv[3]) > 0) {
+			settings.imagesPerBatch = static_cast<uint32_t>(atoi(argv[3]));
+		}
+
+		// e.g. "llvmpipe" to run on lavapipe
+		const char* deviceName = argc > 4 ? argv[4] : nullptr;
+
+		return runComputeBatchMode(settings, deviceName);
+	}
+
+	// --submit-bench [frames] [producers] [device]: per-producer submit calls against one scheduler flush per frame
+	if (argc > 1 && strcmp(argv[1], "--submit-bench") == 0) {
+		int frameCount = argc > 2 && atoi(argv[2]) > 0 ? atoi(argv[2]) : 2000;
+		int producers = argc > 3 && atoi(argv[3]) > 0 ? atoi(argv[3]) : 8;
+		const char* deviceName = argc > 4 ? argv[4] : nullptr;
+
+		return runSubmitBenchmark(frameCount, producers, deviceName);
+	}
 
 	// Create window
 	initWindow("Test Window", 800, 600);
@@ -34,15 +79,44 @@ int main() {
 		return EXIT_FAILURE;
 	}
 
-	vulkanRenderer.CleanUp();
+	// --capture <trace>: record the whole run for VulkanReplay
+	if (argc > 2 && strcmp(argv[1], "--capture") == 0) {
+		vulkanRenderer.startCapture(argv[2]);
+	}
 
 	// Loop until close
-	while (!glfwWindowShouldClose(window)) {
-		glfwPollEvents();
+	int exitCode = 0;
+	try {
+		while (!glfwWindowShouldClose(window)) {
+			// Pace before polling, so the frame is built from the freshest input
+			vulkanRenderer.PaceFrame();
+			glfwPollEvents();
+
+			// 1, 2, 3 switch between present latency modes
+			if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS) {
+				vulkanRenderer.setPresentLatencyMode(PresentLatencyMode::LowLatency);
+			}
+			else if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS) {
+				vulkanRenderer.setPresentLatencyMode(PresentLatencyMode::Throughput);
+			}
+			else if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS) {
+				vulkanRenderer.setPresentLatencyMode(PresentLatencyMode::PowerSaving);
+			}
+
+			vulkanRenderer.draw();
+		}
+	}
+	catch (const std::runtime_error& e) {
+		// Still clean up below, so the device and everything on it are destroyed properly
+		printf("ERROR: %s\n", e.what());
+		exitCode = EXIT_FAILURE;
 	}
 
+	vulkanRenderer.printPacingReport();
+	vulkanRenderer.CleanUp();
+
 	glfwDestroyWindow(window);
 	glfwTerminate();
 
-	return 0;
+	return exitCode;
 }
\ No newline at end of file
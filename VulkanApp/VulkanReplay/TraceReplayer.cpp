@@ -0,0 +1,651 @@
+#include "TraceReplayer.h"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+TraceReplayer::TraceReplayer()
+{
+}
+
+TraceReplayer::~TraceReplayer()
+{
+}
+
+void TraceReplayer::init(VulkanContext* newContext, TraceReader* newTrace)
+{
+	context = newContext;
+	trace = newTrace;
+
+	CreateDescriptorSetLayout();
+	CreatePipelineLayout();
+	CreateDescriptorPool();
+	CreateFrames();
+	CreateTimestampPool();
+}
+
+void TraceReplayer::Run(const ReplaySettings& settings)
+{
+	VkDevice device = context->getLogicalDevice();
+	VkQueue queue = context->getComputeQueue();
+
+	auto replayStart = std::chrono::steady_clock::now();
+	auto frameStart = replayStart;
+	ReplayFrame* frame = nullptr;						// Frame currently being recorded, null between Submit and BeginFrame
+
+	uint64_t firstTimestampNs = 0;
+	uint64_t lastTimestampNs = 0;
+	bool firstFrame = true;
+
+	for (uint32_t loop = 0; loop < settings.loops; loop++) {
+		trace->Rewind();
+
+		// Each loop restarts the original timeline from wherever the last one finished
+		auto loopStart = std::chrono::steady_clock::now();
+		bool firstFrameOfLoop = true;
+
+		TraceOp op;
+		const uint8_t* payload;
+		uint16_t size;
+		while (trace->Next(op, payload, size)) {
+			switch (op) {
+			case TraceOp::CreateImage: {
+				TraceCreateImage record;
+				memcpy(&record, payload, sizeof(record));
+				ReplayCreateImage(record);
+				break;
+			}
+
+			case TraceOp::CreateUniformBuffer: {
+				TraceCreateUniformBuffer record;
+				memcpy(&record, payload, sizeof(record));
+				ReplayCreateUniformBuffer(record);
+				break;
+			}
+
+			case TraceOp::WriteBuffer: {
+				TraceWriteBuffer record;
+				memcpy(&record, payload, sizeof(record));
+
+				// Memory is coherent, and the frame that last read this region has retired, same as in the captured run
+				auto it = buffers.find(record.bufferId);
+				if (it == buffers.end() || record.offset < record.baseOffset) {
+					break;
+				}
+
+				// The write moves with its allocation, chunks of a split write stay contiguous after it
+				uint64_t offset = remapOffset(it->second, record.baseOffset) + (record.offset - record.baseOffset);
+				if (offset + record.size <= it->second.size) {
+					memcpy(it->second.mapped + offset, payload + sizeof(record), record.size);
+				}
+				break;
+			}
+
+			case TraceOp::BeginFrame: {
+				TraceBeginFrame record;
+				memcpy(&record, payload, sizeof(record));
+
+				// -- WAIT FOR FRAME --
+				frame = &frames[replayedFrames % frames.size()];
+				vkWaitForFences(device, 1, &frame->fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+				CollectGpuTime(*frame);
+				vkResetFences(device, 1, &frame->fence);
+
+				// -- PACING --
+				// Start each frame at the same offset from the start of the loop as in the captured run
+				if (firstFrameOfLoop) {
+					firstTimestampNs = record.timestampNs;
+				}
+				if (!settings.maxThroughput) {
+					std::this_thread::sleep_until(loopStart + std::chrono::nanoseconds(record.timestampNs - firstTimestampNs));
+				}
+
+				auto now = std::chrono::steady_clock::now();
+
+				ReplayFrameTiming timing = {};
+				timing.capturedFrame = record.frameNumber;
+				timing.capturedMs = firstFrame || firstFrameOfLoop ? 0.0 : (record.timestampNs - lastTimestampNs) / 1.0e6;
+				timing.frameMs = firstFrame ? 0.0 : std::chrono::duration<double, std::milli>(now - frameStart).count();
+				timing.gpuMs = -1.0;
+				frame->timingIndex = static_cast<int64_t>(frameTimings.size());
+				frameTimings.push_back(timing);
+
+				frameStart = now;
+				lastTimestampNs = record.timestampNs;
+				firstFrame = false;
+				firstFrameOfLoop = false;
+
+				// -- RECORD --
+				VkCommandBufferBeginInfo bufferBeginInfo = {};
+				bufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+				bufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+				if (vkBeginCommandBuffer(frame->commandBuffer, &bufferBeginInfo) != VK_SUCCESS) {
+					throw std::runtime_error("Failed to start recording a Command Buffer!");
+				}
+
+				if (timestampPool != VK_NULL_HANDLE) {
+					uint32_t firstQuery = static_cast<uint32_t>(replayedFrames % frames.size()) * 2;
+					vkCmdResetQueryPool(frame->commandBuffer, timestampPool, firstQuery, 2);
+					vkCmdWriteTimestamp(frame->commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool, firstQuery);
+				}
+				break;
+			}
+
+			case TraceOp::CmdImageBarrier: {
+				TraceImageBarrier record;
+				memcpy(&record, payload, sizeof(record));
+
+				auto it = images.find(record.imageId);
+				if (frame == nullptr || it == images.end()) {
+					break;
+				}
+
+				VkImageMemoryBarrier imageBarrier = {};
+				imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+				imageBarrier.oldLayout = replayLayout(record.oldLayout);
+				imageBarrier.newLayout = replayLayout(record.newLayout);
+				imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				imageBarrier.image = it->second.image;
+				imageBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				imageBarrier.subresourceRange.baseMipLevel = 0;
+				imageBarrier.subresourceRange.levelCount = 1;
+				imageBarrier.subresourceRange.baseArrayLayer = 0;
+				imageBarrier.subresourceRange.layerCount = 1;
+				imageBarrier.srcAccessMask = record.srcAccess;
+				imageBarrier.dstAccessMask = record.dstAccess;
+
+				vkCmdPipelineBarrier(frame->commandBuffer, replayStages(record.srcStage), replayStages(record.dstStage),
+					0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+				break;
+			}
+
+			case TraceOp::CmdClearColorImage: {
+				TraceClearColorImage record;
+				memcpy(&record, payload, sizeof(record));
+
+				auto it = images.find(record.imageId);
+				if (frame == nullptr || it == images.end()) {
+					break;
+				}
+
+				VkClearColorValue colour = {};
+				memcpy(colour.float32, record.colour, sizeof(record.colour));
+
+				VkImageSubresourceRange range = {};
+				range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				range.baseMipLevel = 0;
+				range.levelCount = 1;
+				range.baseArrayLayer = 0;
+				range.layerCount = 1;
+
+				vkCmdClearColorImage(frame->commandBuffer, it->second.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &colour, 1, &range);
+				break;
+			}
+
+			case TraceOp::CmdBindUniformBuffer: {
+				TraceBindUniformBuffer record;
+				memcpy(&record, payload, sizeof(record));
+
+				auto it = buffers.find(record.bufferId);
+				if (frame == nullptr || it == buffers.end()) {
+					break;
+				}
+
+				// Replay has no graphics pipeline, the compute bind point keeps the same descriptor work
+				uint32_t dynamicOffset = static_cast<uint32_t>(remapOffset(it->second, record.dynamicOffset));
+				vkCmdBindDescriptorSets(frame->commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout,
+					0, 1, &it->second.descriptorSet, 1, &dynamicOffset);
+				break;
+			}
+
+			case TraceOp::Submit: {
+				if (frame == nullptr) {
+					break;
+				}
+
+				if (timestampPool != VK_NULL_HANDLE) {
+					uint32_t firstQuery = static_cast<uint32_t>(replayedFrames % frames.size()) * 2;
+					vkCmdWriteTimestamp(frame->commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampPool, firstQuery + 1);
+				}
+
+				if (vkEndCommandBuffer(frame->commandBuffer) != VK_SUCCESS) {
+					throw std::runtime_error("Failed to stop recording a Command Buffer!");
+				}
+
+				VkSubmitInfo submitInfo = {};
+				submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+				submitInfo.commandBufferCount = 1;
+				submitInfo.pCommandBuffers = &frame->commandBuffer;
+
+				if (vkQueueSubmit(queue, 1, &submitInfo, frame->fence) != VK_SUCCESS) {
+					throw std::runtime_error("Failed to submit Command Buffer to Queue!");
+				}
+
+				frameTimings[frame->timingIndex].cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+
+				replayedFrames++;
+				frame = nullptr;
+				break;
+			}
+
+			case TraceOp::Present:
+				// Nothing to present to, the images just stay in their last layout
+				presents++;
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		// A trace that ends mid-frame leaves a command buffer open, close it without submitting
+		if (frame != nullptr) {
+			vkEndCommandBuffer(frame->commandBuffer);
+			frameTimings.pop_back();
+			frame->timingIndex = -1;
+
+			// The fence was reset in BeginFrame, signal it with an empty submit to keep the slot usable
+			vkQueueSubmit(queue, 0, nullptr, frame->fence);
+			frame = nullptr;
+		}
+	}
+
+	vkDeviceWaitIdle(device);
+	replaySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - replayStart).count();
+
+	for (auto& replayFrame : frames) {
+		CollectGpuTime(replayFrame);
+	}
+}
+
+void TraceReplayer::printReport(const ReplaySettings& settings) const
+{
+	// -- PER FRAME --
+	std::ofstream timingFile;
+	if (!settings.timingPath.empty()) {
+		timingFile.open(settings.timingPath, std::ios::trunc);
+		if (!timingFile.is_open()) {
+			printf("Failed to open %s, printing frame timings instead\n", settings.timingPath.c_str());
+		}
+	}
+
+	auto writeLine = [&timingFile](const char* line) {
+		if (timingFile.is_open()) {
+			timingFile << line;
+		}
+		else {
+			fputs(line, stdout);
+		}
+	};
+
+	writeLine("frame,captured_ms,frame_ms,cpu_ms,gpu_ms\n");
+	for (const auto& timing : frameTimings) {
+		char line[160];
+		snprintf(line, sizeof(line), "%llu,%.3f,%.3f,%.3f,%.3f\n", static_cast<unsigned long long>(timing.capturedFrame),
+			timing.capturedMs, timing.frameMs, timing.cpuMs, timing.gpuMs);
+		writeLine(line);
+	}
+
+	// -- SUMMARY --
+	auto summarise = [](const char* label, std::vector<double> values) {
+		values.erase(std::remove_if(values.begin(), values.end(), [](double value) { return value < 0.0; }), values.end());
+		if (values.empty()) {
+			printf("  %-9s n/a\n", label);
+			return;
+		}
+
+		std::sort(values.begin(), values.end());
+		double sum = 0.0;
+		for (double value : values) {
+			sum += value;
+		}
+		size_t p99 = std::min(values.size() - 1, static_cast<size_t>(values.size() * 0.99));
+		printf("  %-9s mean %7.3f ms  min %7.3f  p50 %7.3f  p99 %7.3f  max %7.3f\n", label,
+			sum / values.size(), values.front(), values[values.size() / 2], values[p99], values.back());
+	};
+
+	// Skip the first frame of the run, it has no previous frame to measure from
+	std::vector<double> capturedMs, frameMs, cpuMs, gpuMs;
+	for (size_t i = 1; i < frameTimings.size(); i++) {
+		if (frameTimings[i].capturedMs > 0.0) {
+			capturedMs.push_back(frameTimings[i].capturedMs);
+		}
+		frameMs.push_back(frameTimings[i].frameMs);
+		cpuMs.push_back(frameTimings[i].cpuMs);
+		gpuMs.push_back(frameTimings[i].gpuMs);
+	}
+
+	printf("Replayed %llu frames (%llu presents) in %.3f s = %.1f fps, %s\n",
+		static_cast<unsigned long long>(replayedFrames), static_cast<unsigned long long>(presents), replaySeconds,
+		replaySeconds > 0.0 ? replayedFrames / replaySeconds : 0.0, settings.maxThroughput ? "max throughput" : "captured pacing");
+	summarise("captured", capturedMs);
+	summarise("frame", frameMs);
+	summarise("cpu", cpuMs);
+	summarise("gpu", gpuMs);
+}
+
+void TraceReplayer::CreateDescriptorSetLayout()
+{
+	// Same shape as the renderer's uniform ring: one dynamic uniform buffer
+	VkDescriptorSetLayoutBinding binding = {};
+	binding.binding = 0;														// Binding point in shader
+	binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;			// Type of descriptor
+	binding.descriptorCount = 1;												// Number of descriptors for binding
+	binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;							// Shader stage to bind to
+	binding.pImmutableSamplers = nullptr;
+
+	VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+	layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutCreateInfo.bindingCount = 1;
+	layoutCreateInfo.pBindings = &binding;
+
+	VkResult result = vkCreateDescriptorSetLayout(context->getLogicalDevice(), &layoutCreateInfo, nullptr, &descriptorSetLayout);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Descriptor Set Layout!");
+	}
+
+	context->getDeletionQueue().push([this]() {
+		vkDestroyDescriptorSetLayout(context->getLogicalDevice(), descriptorSetLayout, nullptr);
+	});
+}
+
+void TraceReplayer::CreatePipelineLayout()
+{
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayout;
+
+	VkResult result = vkCreatePipelineLayout(context->getLogicalDevice(), &pipelineLayoutCreateInfo, nullptr, &pipelineLayout);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create Pipeline Layout!");
+	}
+
+	context->getDeletionQueue().push([this]() {
+		vkDestroyPipelineLayout(context->getLogicalDevice(), pipelineLayout, nullptr);
+	});
+}
+
+void TraceReplayer::CreateDescriptorPool()
+{
+	VkDescriptorPoolSize poolSize = {};
+	poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	poolSize.descriptorCount = MAX_REPLAY_UNIFORM_BUFFERS;
+
+	VkDescriptorPoolCreateInfo poolCreateInfo = {};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.maxSets = MAX_REPLAY_UNIFORM_BUFFERS;						// Maximum number of Descriptor Sets that can be created from pool
+	poolCreateInfo.poolSizeCount = 1;											// Amount of Pool Sizes being passed
+	poolCreateInfo.pPoolSizes = &poolSize;										// Pool Sizes to create pool with
+
+	VkResult result = vkCreateDescriptorPool(context->getLogicalDevice(), &poolCreateInfo, nullptr, &descriptorPool);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Descriptor Pool!");
+	}
+
+	context->getDeletionQueue().push([this]() {
+		vkDestroyDescriptorPool(context->getLogicalDevice(), descriptorPool, nullptr);
+	});
+}
+
+void TraceReplayer::CreateFrames()
+{
+	VkDevice device = context->getLogicalDevice();
+
+	// Uniform writes in the trace only avoid regions still in use if no more frames are in flight than when captured
+	uint32_t framesInFlight = std::max(1u, std::min(trace->getHeader().framesInFlight, 8u));
+	frames.resize(framesInFlight);
+
+	std::vector<VkCommandBuffer> commandBuffers(frames.size());
+
+	VkCommandBufferAllocateInfo cbAllocInfo = {};
+	cbAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	cbAllocInfo.commandPool = context->getComputeCommandPool();
+	cbAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	cbAllocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+
+	VkResult result = vkAllocateCommandBuffers(device, &cbAllocInfo, commandBuffers.data());
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to allocate Command Buffers!");
+	}
+
+	// Start signalled, so a slot that has never been used doesn't need special casing
+	VkFenceCreateInfo fenceCreateInfo = {};
+	fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+	for (size_t i = 0; i < frames.size(); i++) {
+		frames[i].commandBuffer = commandBuffers[i];
+
+		result = vkCreateFence(device, &fenceCreateInfo, nullptr, &frames[i].fence);
+		if (result != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create a Fence!");
+		}
+	}
+
+	context->getDeletionQueue().push([this]() {
+		for (auto& frame : frames) {
+			vkDestroyFence(context->getLogicalDevice(), frame.fence, nullptr);
+		}
+	});
+}
+
+void TraceReplayer::CreateTimestampPool()
+{
+	// Timestamps are optional per queue family, without them GPU times are reported as n/a
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(context->getPhysicalDevice(), &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilyList(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(context->getPhysicalDevice(), &queueFamilyCount, queueFamilyList.data());
+
+	int computeFamily = context->getQueueFamilyIndices().computeFamily;
+	if (queueFamilyList[computeFamily].timestampValidBits == 0) {
+		printf("Queue family %d has no timestamp support, GPU times disabled\n", computeFamily);
+		return;
+	}
+
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(context->getPhysicalDevice(), &deviceProperties);
+	timestampPeriodMs = deviceProperties.limits.timestampPeriod / 1.0e6;
+
+	// Start and end timestamp per frame in flight
+	VkQueryPoolCreateInfo queryPoolCreateInfo = {};
+	queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolCreateInfo.queryCount = static_cast<uint32_t>(frames.size() * 2);
+
+	VkResult result = vkCreateQueryPool(context->getLogicalDevice(), &queryPoolCreateInfo, nullptr, &timestampPool);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a Query Pool!");
+	}
+
+	context->getDeletionQueue().push([this]() {
+		vkDestroyQueryPool(context->getLogicalDevice(), timestampPool, nullptr);
+	});
+}
+
+void TraceReplayer::ReplayCreateImage(const TraceCreateImage& record)
+{
+	// Looping replays the whole trace, objects from the first pass are reused
+	if (images.count(record.imageId) > 0) {
+		return;
+	}
+
+	VkPhysicalDevice physicalDevice = context->getPhysicalDevice();
+	VkDevice device = context->getLogicalDevice();
+
+	// Stands in for a swapchain image: same format and size, only ever cleared and transitioned
+	VkImageCreateInfo imageCreateInfo = {};
+	imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageCreateInfo.format = static_cast<VkFormat>(record.format);
+	imageCreateInfo.extent = { record.width, record.height, 1 };
+	imageCreateInfo.mipLevels = 1;
+	imageCreateInfo.arrayLayers = 1;
+	imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	ReplayImage replayImage = {};
+	VkResult result = vkCreateImage(device, &imageCreateInfo, nullptr, &replayImage.image);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create a replay Image!");
+	}
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements(device, replayImage.image, &memoryRequirements);
+
+	VkMemoryAllocateInfo memoryAllocInfo = {};
+	memoryAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memoryAllocInfo.allocationSize = memoryRequirements.size;
+	memoryAllocInfo.memoryTypeIndex = findMemoryTypeIndex(physicalDevice, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	if (memoryAllocInfo.memoryTypeIndex == UINT32_MAX) {
+		throw std::runtime_error("Failed to find a memory type for a replay Image!");
+	}
+
+	result = vkAllocateMemory(device, &memoryAllocInfo, nullptr, &replayImage.memory);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to allocate replay Image memory!");
+	}
+	vkBindImageMemory(device, replayImage.image, replayImage.memory, 0);
+
+	images[record.imageId] = replayImage;
+
+	context->getDeletionQueue().push([device, replayImage]() {
+		vkDestroyImage(device, replayImage.image, nullptr);
+		vkFreeMemory(device, replayImage.memory, nullptr);
+	});
+}
+
+void TraceReplayer::ReplayCreateUniformBuffer(const TraceCreateUniformBuffer& record)
+{
+	if (buffers.count(record.bufferId) > 0) {
+		return;
+	}
+	if (buffers.size() >= MAX_REPLAY_UNIFORM_BUFFERS) {
+		throw std::runtime_error("Trace has more uniform buffers than the replay descriptor pool!");
+	}
+
+	VkDevice device = context->getLogicalDevice();
+
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(context->getPhysicalDevice(), &deviceProperties);
+
+	// The shader sees the whole range, so it can't be shrunk to fit a smaller limit
+	if (record.range > deviceProperties.limits.maxUniformBufferRange) {
+		throw std::runtime_error("Trace binds " + std::to_string(record.range) + " byte uniform ranges, this device's maxUniformBufferRange is "
+			+ std::to_string(deviceProperties.limits.maxUniformBufferRange) + "!");
+	}
+
+	// Offsets in the trace are aligned for the capture device, which may be looser than this one
+	ReplayBuffer replayBuffer = {};
+	replayBuffer.capturedAlignment = std::max<uint64_t>(record.offsetAlignment, 1);
+
+	// Both alignments are powers of two, so the larger is a multiple of both. Every captured alignment step
+	// becomes one stride here, so allocations keep their order and never overlap, and the buffer grows to match
+	replayBuffer.offsetStride = std::max<uint64_t>(replayBuffer.capturedAlignment, deviceProperties.limits.minUniformBufferOffsetAlignment);
+	replayBuffer.size = (record.size + replayBuffer.capturedAlignment - 1) / replayBuffer.capturedAlignment * replayBuffer.offsetStride;
+	if (replayBuffer.offsetStride != replayBuffer.capturedAlignment) {
+		printf("Uniform buffer %u: remapping %llu byte offset alignment to %llu\n", record.bufferId,
+			static_cast<unsigned long long>(replayBuffer.capturedAlignment), static_cast<unsigned long long>(replayBuffer.offsetStride));
+	}
+
+	createBuffer(context->getPhysicalDevice(), device, replayBuffer.size, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &replayBuffer.buffer, &replayBuffer.memory);
+
+	// Persistently mapped, like the ring it stands in for
+	if (vkMapMemory(device, replayBuffer.memory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&replayBuffer.mapped)) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to map replay uniform buffer memory!");
+	}
+
+	VkDescriptorSetAllocateInfo setAllocInfo = {};
+	setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	setAllocInfo.descriptorPool = descriptorPool;								// Pool to allocate Descriptor Set from
+	setAllocInfo.descriptorSetCount = 1;										// Number of sets to allocate
+	setAllocInfo.pSetLayouts = &descriptorSetLayout;							// Layouts to use to allocate sets
+
+	VkResult result = vkAllocateDescriptorSets(device, &setAllocInfo, &replayBuffer.descriptorSet);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("Failed to allocate Descriptor Sets!");
+	}
+
+	VkDescriptorBufferInfo bufferInfo = {};
+	bufferInfo.buffer = replayBuffer.buffer;									// Buffer to get data from
+	bufferInfo.offset = 0;														// Dynamic offset is added on bind
+	bufferInfo.range = record.range;											// Size of data visible per bind
+
+	VkWriteDescriptorSet setWrite = {};
+	setWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	setWrite.dstSet = replayBuffer.descriptorSet;								// Descriptor Set to update
+	setWrite.dstBinding = 0;													// Binding to update (matches binding on layout/shader)
+	setWrite.dstArrayElement = 0;												// Index in array to update
+	setWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;		// Type of descriptor
+	setWrite.descriptorCount = 1;												// Amount to update
+	setWrite.pBufferInfo = &bufferInfo;											// Information about buffer data to bind
+
+	vkUpdateDescriptorSets(device, 1, &setWrite, 0, nullptr);
+
+	buffers[record.bufferId] = replayBuffer;
+
+	context->getDeletionQueue().push([device, replayBuffer]() {
+		vkDestroyBuffer(device, replayBuffer.buffer, nullptr);
+		vkFreeMemory(device, replayBuffer.memory, nullptr);			// Freeing also unmaps
+	});
+}
+
+void TraceReplayer::CollectGpuTime(ReplayFrame& frame)
+{
+	// Called once the frame's fence has signalled, so results are available without waiting
+	if (frame.timingIndex < 0) {
+		return;
+	}
+
+	if (timestampPool != VK_NULL_HANDLE) {
+		uint32_t firstQuery = static_cast<uint32_t>(&frame - frames.data()) * 2;
+		uint64_t timestamps[2] = {};
+		VkResult result = vkGetQueryPoolResults(context->getLogicalDevice(), timestampPool, firstQuery, 2,
+			sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		if (result == VK_SUCCESS) {
+			frameTimings[frame.timingIndex].gpuMs = (timestamps[1] - timestamps[0]) * timestampPeriodMs;
+		}
+	}
+
+	frame.timingIndex = -1;
+}
+
+uint64_t TraceReplayer::remapOffset(const ReplayBuffer& buffer, uint64_t capturedOffset) const
+{
+	// Only allocation starts are remapped, anything else means the trace doesn't match its own alignment
+	if (capturedOffset % buffer.capturedAlignment != 0) {
+		throw std::runtime_error("Trace uniform offset " + std::to_string(capturedOffset) + " isn't aligned to the captured alignment!");
+	}
+
+	uint64_t offset = capturedOffset / buffer.capturedAlignment * buffer.offsetStride;
+	if (offset > std::numeric_limits<uint32_t>::max()) {
+		throw std::runtime_error("Remapped uniform offset doesn't fit in a dynamic offset!");
+	}
+
+	return offset;
+}
+
+VkImageLayout TraceReplayer::replayLayout(uint32_t capturedLayout) const
+{
+	// Replay images can't be presented, so they wait in TRANSFER_SRC instead
+	VkImageLayout layout = static_cast<VkImageLayout>(capturedLayout);
+	return layout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : layout;
+}
+
+VkPipelineStageFlags TraceReplayer::replayStages(uint32_t capturedStages) const
+{
+	// Replay may run on a compute-only queue, where graphics stages aren't allowed in barriers
+	const VkPipelineStageFlags computeQueueStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+		| VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+	return (capturedStages & ~computeQueueStages) != 0 ? VK_PIPELINE_STAGE_ALL_COMMANDS_BIT : capturedStages;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdexcept>
+#include <vector>
+#include <string>
+#include <map>
+#include <chrono>
+
+#include "../VulkanApp/Utilities.h"
+#include "../VulkanApp/VulkanContext.h"
+#include "../VulkanApp/TraceFile.h"
+
+const uint32_t MAX_REPLAY_UNIFORM_BUFFERS = 16;		// Descriptor pool size, the renderer only has one uniform ring
+
+struct ReplaySettings {
+	bool maxThroughput = false;						// No pacing: submit each frame as soon as its slot is free
+	uint32_t loops = 1;								// Times to replay the trace back to back
+	std::string timingPath;							// Per-frame timing CSV, printed to stdout if empty
+};
+
+struct ReplayFrameTiming {
+	uint64_t capturedFrame;							// Frame number in the original run
+	double capturedMs;								// Original frame time, from the trace timestamps
+	double frameMs;									// Replay frame time (start to start)
+	double cpuMs;									// Recording and submitting the frame
+	double gpuMs;									// Timestamp queries around the frame's commands, -1 if unsupported
+};
+
+// Re-issues a trace written by VulkanCapture on a headless context. Swapchain images become
+// offscreen images of the same format and size, presents are counted but not performed.
+class TraceReplayer
+{
+public:
+	TraceReplayer();
+	~TraceReplayer();
+
+	void init(VulkanContext* newContext, TraceReader* newTrace);
+	void Run(const ReplaySettings& settings);
+	void printReport(const ReplaySettings& settings) const;
+
+private:
+	struct ReplayImage {
+		VkImage image;
+		VkDeviceMemory memory;
+	};
+
+	struct ReplayBuffer {
+		VkBuffer buffer;
+		VkDeviceMemory memory;
+		uint8_t* mapped;
+		VkDeviceSize size;									// Grown from the captured size if offsets had to be spread out
+		VkDeviceSize capturedAlignment;						// Capture device's minUniformBufferOffsetAlignment
+		VkDeviceSize offsetStride;							// What each captured alignment step becomes on this device
+		VkDescriptorSet descriptorSet;
+	};
+
+	struct ReplayFrame {
+		VkCommandBuffer commandBuffer;
+		VkFence fence;
+		int64_t timingIndex = -1;					// Timing entry waiting on this slot's GPU timestamps
+	};
+
+	VulkanContext* context = nullptr;
+	TraceReader* trace = nullptr;
+
+	// - Descriptors
+	VkDescriptorSetLayout descriptorSetLayout;
+	VkPipelineLayout pipelineLayout;
+	VkDescriptorPool descriptorPool;
+
+	// - Frames
+	std::vector<ReplayFrame> frames;				// One per frame in flight in the captured run
+	VkQueryPool timestampPool = VK_NULL_HANDLE;
+	double timestampPeriodMs = 0.0;					// Milliseconds per timestamp tick, 0 if timestamps unsupported
+	uint64_t replayedFrames = 0;
+	uint64_t presents = 0;
+
+	// - Trace Objects
+	std::map<uint32_t, ReplayImage> images;
+	std::map<uint32_t, ReplayBuffer> buffers;
+
+	// - Timing
+	std::vector<ReplayFrameTiming> frameTimings;
+	double replaySeconds = 0.0;
+
+	// Vulkan Functions
+	// - Create Functions
+	void CreateDescriptorSetLayout();
+	void CreatePipelineLayout();
+	void CreateDescriptorPool();
+	void CreateFrames();
+	void CreateTimestampPool();
+
+	// - Replay Functions
+	void ReplayCreateImage(const TraceCreateImage& record);
+	void ReplayCreateUniformBuffer(const TraceCreateUniformBuffer& record);
+	void CollectGpuTime(ReplayFrame& frame);
+
+	// - Support Functions
+	uint64_t remapOffset(const ReplayBuffer& buffer, uint64_t capturedOffset) const;
+	VkImageLayout replayLayout(uint32_t capturedLayout) const;
+	VkPipelineStageFlags replayStages(uint32_t capturedStages) const;
+};
@@ -0,0 +1,84 @@
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <stdexcept>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "../VulkanApp/VulkanContext.h"
+#include "../VulkanApp/TraceFile.h"
+#include "TraceReplayer.h"
+
+static void printUsage()
+{
+	printf("Usage: VulkanReplay <trace> [--max-throughput] [--loops N] [--device name] [--csv path]\n");
+	printf("  --max-throughput  ignore the captured frame times and replay as fast as the device allows\n");
+	printf("  --loops N         replay the trace N times back to back\n");
+	printf("  --device name     run on the first device whose name contains this, e.g. llvmpipe\n");
+	printf("  --csv path        write per-frame timings to a file instead of stdout\n");
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	ReplaySettings settings;
+	const char* deviceName = nullptr;
+
+	for (int i = 2; i < argc; i++) {
+		if (strcmp(argv[i], "--max-throughput") == 0) {
+			settings.maxThroughput = true;
+		}
+		else if (strcmp(argv[i], "--loops") == 0 && i + 1 < argc) {
+			settings.loops = static_cast<uint32_t>(std::max(1, atoi(argv[++i])));
+		}
+		else if (strcmp(argv[i], "--device") == 0 && i + 1 < argc) {
+			deviceName = argv[++i];
+		}
+		else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+			settings.timingPath = argv[++i];
+		}
+		else {
+			printUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	TraceReader trace;
+	if (!trace.Open(argv[1])) {
+		printf("ERROR: %s is not a readable trace (version %u)\n", argv[1], TRACE_VERSION);
+		return EXIT_FAILURE;
+	}
+
+	VulkanContext context;
+	TraceReplayer replayer;
+
+	try {
+		context.CreateInstance(true);
+		context.CreateComputeDevice(deviceName);
+
+		VkPhysicalDeviceProperties deviceProperties;
+		vkGetPhysicalDeviceProperties(context.getPhysicalDevice(), &deviceProperties);
+		printf("Replaying %s (%zu bytes, captured on %s, %u frames in flight) on %s\n",
+			argv[1], trace.getSize(), trace.getHeader().deviceName, trace.getHeader().framesInFlight, deviceProperties.deviceName);
+
+		replayer.init(&context, &trace);
+		replayer.Run(settings);
+	}
+	catch (const std::runtime_error& e) {
+		printf("ERROR: %s\n", e.what());
+		context.CleanUp();
+		return EXIT_FAILURE;
+	}
+
+	context.CleanUp();
+	replayer.printReport(settings);
+
+	return EXIT_SUCCESS;
+}